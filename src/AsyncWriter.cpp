@@ -0,0 +1,213 @@
+//Title: AsyncWriter.cpp
+//Description: Double-buffered output file written by a dedicated thread, so that formatting of rows never waits for the disk unless both buffers are full.
+//             Writes are large and sequential (a whole buffer at a time); with O_DIRECT, only whole blocks are written from each buffer and the remainder is carried over to the next one.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "AsyncWriter.h"
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+
+
+//Constructor
+//If directIO is set, the file is opened with O_DIRECT and disk space is reserved ahead of the written data; if the file system does not support O_DIRECT, the page cache is used
+//If resumeAt is not negative, the existing file is truncated to that many bytes and written on from there (e.g., resuming a run from a snapshot), instead of being emptied
+AsyncWriter::AsyncWriter(const char *outFileName, bool directIO, long resumeAt)
+{
+    int flags = (resumeAt < 0) ? (O_WRONLY | O_CREAT | O_TRUNC) : (O_RDWR | O_CREAT);
+    this->directIO = false;
+    this->fd = -1;
+    if (directIO) {
+        fd = open(outFileName, flags | O_DIRECT, 0644);
+        this->directIO = (fd >= 0);
+    }
+    if (fd < 0)
+        fd = open(outFileName, flags, 0644);
+    failed = (fd < 0);
+
+    for (int i = 0; i < 2; i++) {
+        void *b = NULL;
+        if (posix_memalign(&b, DIRECT_IO_BLOCK, OUTPUT_BUFFER_SIZE) != 0)
+            b = malloc(OUTPUT_BUFFER_SIZE);
+        buffers[i] = (char *)b;
+    }
+    filled = new SpscQueue< pair<char *, size_t> >(2);
+    empty = new SpscQueue< char * >(2);
+    empty->put(buffers[1]);
+    offset = 0;
+    allocated = 0;
+    stalls = 0;
+    closed = false;
+    carried = 0;
+
+    //With O_DIRECT, writes resume from the start of the last partial block, which is read back into the first buffer
+    if ((resumeAt >= 0) && !failed) {
+        offset = this->directIO ? (resumeAt & ~((long)DIRECT_IO_BLOCK - 1)) : resumeAt;
+        carried = resumeAt - offset;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+        if ((pread(fd, buffers[0], carried, offset) != (ssize_t)carried) || (ftruncate(fd, resumeAt) != 0) || (lseek(fd, offset, SEEK_SET) < 0)) {
+            std::cerr << "Failed resuming output file: " << strerror(errno) << std::endl;
+            ::close(fd);
+            fd = -1;
+            failed = true;
+        }
+        else if (this->directIO)
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_DIRECT);
+        allocated = offset;
+    }
+    submitted = offset;
+    completed.store(offset);
+
+    worker = thread(&AsyncWriter::writeBuffers, this);
+}
+
+
+//Destructor
+AsyncWriter::~AsyncWriter()
+{
+    close(NULL, 0);
+    delete filled;
+    delete empty;
+    free(buffers[0]);
+    free(buffers[1]);
+}
+
+
+//Buffer for formatting the first rows; length is set to the bytes it already holds
+char *AsyncWriter::getBuffer(size_t &length)
+{
+    length = carried;
+    return buffers[0];
+}
+
+
+//Hand over a buffer with the given number of bytes to the writer thread and get an empty one in return; waits only if the other buffer is still being written
+//With O_DIRECT, trailing bytes beyond the last whole block are copied into the returned buffer and their number is given back in length
+char *AsyncWriter::submit(char *buffer, size_t &length)
+{
+    size_t n = directIO ? (length & ~((size_t)DIRECT_IO_BLOCK - 1)) : length;
+    if (n == 0)
+        return buffer;
+
+    char *next;
+    if (!empty->pop(next)) {
+        stalls++;
+        next = empty->take();
+    }
+    memcpy(next, buffer + n, length - n);
+    filled->put(make_pair(buffer, n));
+    submitted += n;
+    length -= n;
+    return next;
+}
+
+
+//Write all rows given so far into the file and get its length in bytes (e.g., for a snapshot of the run); -1 if the output is incomplete
+//Waits for the writer thread; with O_DIRECT, trailing bytes beyond the last whole block are also written through the page cache, and written again along with that block later on
+long AsyncWriter::sync(char *&buffer, size_t &length)
+{
+    buffer = submit(buffer, length);
+    while (completed.load(std::memory_order_acquire) < submitted)
+        std::this_thread::yield();
+
+    if ((length > 0) && (fd >= 0)) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+        for (size_t n = 0; (n < length) && !failed; ) {
+            ssize_t w = pwrite(fd, buffer + n, length - n, submitted + n);
+            if ((w < 0) && (errno != EINTR)) {
+                std::cerr << "Failed writing into output file: " << strerror(errno) << std::endl;
+                failed = true;
+            }
+            else if (w > 0)
+                n += w;
+        }
+        if (directIO)
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_DIRECT);
+    }
+    return failed ? -1 : (long)(submitted + length);
+}
+
+
+//Write the given remaining bytes, wait for the writer thread to complete and close the file
+//False if the output is incomplete, i.e., the file could not be opened, written or closed
+bool AsyncWriter::close(char *buffer, size_t length)
+{
+    if (closed)
+        return !failed;
+    closed = true;
+
+    buffer = submit(buffer, length);
+    filled->put(make_pair((char *)NULL, (size_t)0));     //End of output
+    worker.join();
+
+    //A final partial block cannot be written with O_DIRECT
+    if ((length > 0) && directIO) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+        directIO = false;
+    }
+    writeBytes(buffer, length);
+    if ((fd >= 0) && (::close(fd) != 0)) {
+        std::cerr << "Failed closing output file: " << strerror(errno) << std::endl;
+        failed = true;
+    }
+    fd = -1;
+    return !failed;
+}
+
+
+//Times the caller had to wait for a buffer, i.e., formatting was faster than the disk
+unsigned long AsyncWriter::countStalls()
+{
+    return stalls;
+}
+
+
+//Writer thread: write each filled buffer in turn and return it for formatting
+void AsyncWriter::writeBuffers()
+{
+    while (true) {
+        pair<char *, size_t> item = filled->take();     //Backs off while idle, so as not to compete with the caller for processors
+        if (item.first == NULL)
+            break;
+        writeBytes(item.first, item.second);
+        completed.fetch_add(item.second, std::memory_order_release);
+        empty->put(item.first);
+    }
+}
+
+
+//Write the given bytes into the file, reserving disk space ahead if O_DIRECT is used
+void AsyncWriter::writeBytes(const char *c, size_t n)
+{
+    if ((fd < 0) || (n == 0))
+        return;
+
+    if (directIO && (offset + n > allocated)) {
+        fallocate(fd, FALLOC_FL_KEEP_SIZE, allocated, PREALLOCATE_SIZE);     //Failure only means that no space is reserved
+        allocated += PREALLOCATE_SIZE;
+    }
+
+    while (n > 0) {
+        ssize_t w = write(fd, c, n);
+        if (w < 0) {
+            if (errno == EINTR)
+                continue;
+            if ((errno == EINVAL) && (fcntl(fd, F_GETFL) & O_DIRECT)) {     //O_DIRECT not supported after all
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+                continue;
+            }
+            std::cerr << "Failed writing into output file: " << strerror(errno) << std::endl;
+            ::close(fd);
+            fd = -1;
+            failed = true;      //Only checked by the caller once the writer thread has completed
+            return;
+        }
+        c += w;
+        n -= w;
+        offset += w;
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef ASYNCWRITER_H_
+#define ASYNCWRITER_H_
+
+#include "Config.h"
+#include "SpscQueue.h"
+#include <string.h>
+#include <utility>
+#include <atomic>
+
+using namespace std;
+
+#define DIRECT_IO_BLOCK 4096			//Alignment of buffers, file offsets and lengths of writes with O_DIRECT
+#define PREALLOCATE_SIZE 67108864		//Bytes of disk space reserved ahead of the written data (64 MiB)
+
+
+//Class for writing an output file from a dedicated thread with a pair of buffers: while rows are formatted into one buffer, the other one is being written to disk
+//Buffers are exchanged through lock-free queues, so the caller only waits if the disk cannot keep up with both buffers filled (backpressure)
+//Optionally, the file is written with O_DIRECT (bypassing the page cache) and disk space is reserved ahead with fallocate()
+class AsyncWriter {
+public:
+	AsyncWriter(const char *, bool, long = -1);
+	~AsyncWriter();
+
+	char *getBuffer(size_t &);
+	char *submit(char *, size_t &);
+	long sync(char *&, size_t &);
+	bool close(char *, size_t);
+
+	unsigned long countStalls();
+
+private:
+	int fd;				//Output file descriptor; negative if the file cannot be opened
+	bool directIO;			//Whether the file is currently written with O_DIRECT
+	char *buffers[2];		//Both buffers (OUTPUT_BUFFER_SIZE bytes each), aligned for O_DIRECT
+	SpscQueue< pair<char *, size_t> > *filled;	//Buffers to be written, along with the number of bytes in each one
+	SpscQueue< char * > *empty;			//Buffers already written and available for formatting
+	thread worker;
+	unsigned long offset;		//Bytes written so far
+	unsigned long submitted;	//Bytes handed over to the writer thread so far (including any preceding a resumed output)
+	std::atomic<unsigned long> completed;	//Bytes handed over and already written (or discarded) by the writer thread
+	size_t carried;			//Bytes of a resumed output already in the first buffer (the partial block at its end, with O_DIRECT)
+	unsigned long allocated;	//Bytes of disk space reserved so far
+	unsigned long stalls;		//Times the caller had to wait for a buffer to be written
+	bool closed;
+	bool failed;			//Whether the file could not be opened or any bytes could not be written; further output is discarded
+
+	void writeBuffers();
+	void writeBytes(const char *, size_t);
+};
+
+#endif /*ASYNCWRITER_H_*/
@@ -0,0 +1,86 @@
+//Title: Checkpoint.cpp
+//Description: Binary snapshot of the vessel states, the pending results and the position in the input, so that a later run may resume exactly where the previous one stopped.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "Checkpoint.h"
+#include "Engine.h"
+#include <cstdio>
+
+
+//Write a snapshot of the run into the given file, where t is the upper bound of the latest batch consumed from the scan
+//The snapshot is first written into a temporary file that replaces the given one once complete, so an earlier snapshot survives a failure while writing
+//All results emitted so far are written into the output file beforehand, so the snapshot keeps the length of the output matching its position in the input
+//CAUTION! Only between batches, once the sink has been flushed up to the watermark
+bool Checkpoint::save(const char *fileName, Engine *engine, Sink *sink, Scan *scan, unsigned int t)
+{
+    long length = sink->sync();
+
+    string buf;
+    buf.append(CHECKPOINT_MAGIC, 8);
+    putValue(buf, t);
+    putValue(buf, length);
+    scan->save(buf);
+    sink->save(buf);
+    engine->save(buf);
+    buf.append(CHECKPOINT_MAGIC, 8);
+
+    string tmpName = string(fileName) + ".tmp";
+    ofstream fout(tmpName.c_str(), ios::out | ios::binary | ios::trunc);
+    fout.write(buf.data(), buf.size());
+    fout.close();
+    if (!fout.good())
+        return false;
+    return (rename(tmpName.c_str(), fileName) == 0);
+}
+
+
+//Restore a run from the snapshot in the given file into an engine and a sink without any states or results; t is set to the upper bound of the latest batch
+//States are bound to the configuration of their vessel types in the current settings
+//If the snapshot was taken before the input was exhausted, the scan resumes from the same position in the same input; otherwise, the input of the scan is consumed from its start
+//False if the file is missing or corrupt
+bool Checkpoint::load(const char *fileName, Engine *engine, Sink *sink, Scan *scan, unsigned int &t)
+{
+    ifstream fin(fileName, ios::in | ios::binary);
+    if (!fin.good())
+        return false;
+    fin.seekg(0, ios::end);
+    string buf(fin.tellg(), '\0');
+    fin.seekg(0);
+    fin.read(&buf[0], buf.size());
+    if (!fin.good() || (buf.size() < 16) || (memcmp(buf.data(), CHECKPOINT_MAGIC, 8) != 0) || (memcmp(buf.data() + buf.size() - 8, CHECKPOINT_MAGIC, 8) != 0))
+        return false;
+
+    const char *p = buf.data() + 8;
+    const char *end = buf.data() + buf.size() - 8;
+    long length;
+    return getValue(p, end, t) && getValue(p, end, length) && scan->load(p, end) && sink->load(p, end) && engine->load(p, end) && (p == end);
+}
+
+
+//Size (in bytes) of a snapshot file
+unsigned long Checkpoint::size(const char *fileName)
+{
+    ifstream fin(fileName, ios::in | ios::binary);
+    fin.seekg(0, ios::end);
+    return fin.good() ? (unsigned long)fin.tellg() : 0;
+}
+
+
+//Check whether a snapshot was taken before the end of its input, so that a run resuming the same input must continue the output of that run from there (otherwise, the next run writes a new output)
+//If so, length is set to the length (in bytes) of the output file as of the snapshot, or -1 if it was not a text file; false if the file is missing or corrupt
+bool Checkpoint::resumesOutput(const char *fileName, long &length)
+{
+    char head[8 + sizeof(unsigned int) + sizeof(long) + 1];
+    ifstream fin(fileName, ios::in | ios::binary);
+    fin.read(head, sizeof(head));
+    if (!fin.good() || (memcmp(head, CHECKPOINT_MAGIC, 8) != 0))
+        return false;
+
+    unsigned char exhausted = head[sizeof(head) - 1];     //First field of the scan section
+    if (exhausted)
+        return false;
+    memcpy(&length, head + 8 + sizeof(unsigned int), sizeof(length));
+    return true;
+}
@@ -0,0 +1,99 @@
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include "Location.h"
+#include <string.h>
+#include <string>
+
+using namespace std;
+
+class Engine;
+class Sink;
+class Scan;
+
+
+//Binary snapshot of a run, so that a later run may resume exactly where it stopped (all numbers in native byte order, fixed width)
+//Layout: magic "AISCKP1" (8 bytes, zero-terminated), upper bound of the latest batch (uint32), length of the output file in bytes (int64; -1 if not a text file), then the sections of the scan, the sink and the engine, then the magic again
+//  Scan: exhausted (uint8), latest timestamp (uint32), sequence number of the latest tuple (uint64), skipped tuples (uint32), byte offset in the input (int64),
+//        then a prefetched tuple (uint8 flag, then its identifier, coordinates, timestamp and sequence number)
+//  Sink: order of the next report (uint64), number of pending locations (uint64), then each one as its ordering key (t, trigger, order) and a location record
+//  Engine: number of states (uint64), then per state: identifier (int64), latest refresh (uint32), status bits (uint8), number of locations (uint32) and a location record per location
+//  Location record: a CheckpointLocation (72 bytes)
+#define CHECKPOINT_MAGIC "AISCKP1"
+
+
+//Append a fixed-width value to a snapshot
+template <class T>
+inline void putValue(string &buf, const T &v)
+{
+	buf.append((const char *)&v, sizeof(T));
+}
+
+
+//Read a fixed-width value from a snapshot and advance past it; false if the snapshot is truncated
+template <class T>
+inline bool getValue(const char *&p, const char *end, T &v)
+{
+	if ((size_t)(end - p) < sizeof(T))
+		return false;
+	memcpy(&v, p, sizeof(T));
+	p += sizeof(T);
+	return true;
+}
+
+
+//Record of a location with all its features and annotations in a snapshot
+struct CheckpointLocation {
+	unsigned long seq;
+	long oid;
+	double x;
+	double y;
+	double speed;
+	double heading;
+	double distance;
+	unsigned int t;
+	unsigned int time_elapsed;
+	unsigned long annotation;
+};
+
+
+//Append a location to a snapshot
+inline void putLocation(string &buf, Location *p)
+{
+	CheckpointLocation r = { p->seq, p->oid, p->x, p->y, p->speed, p->heading, p->distance, p->t, p->time_elapsed, p->annotation.to_ulong() };
+	putValue(buf, r);
+}
+
+
+//Read a location from a snapshot; empty if the snapshot is truncated
+inline Location* getLocation(const char *&p, const char *end)
+{
+	CheckpointLocation r;
+	if (!getValue(p, end, r))
+		return NULL;
+
+	Location *q = new Location();
+	q->seq = r.seq;
+	q->oid = r.oid;
+	q->x = r.x;
+	q->y = r.y;
+	q->speed = r.speed;
+	q->heading = r.heading;
+	q->distance = r.distance;
+	q->t = r.t;
+	q->time_elapsed = r.time_elapsed;
+	q->annotation = bitset<11>(r.annotation);
+	return q;
+}
+
+
+//Checkpoint and restore of a run over a single engine: vessel states, pending results in the sink and position in the input
+class Checkpoint {
+public:
+	static bool save(const char *, Engine *, Sink *, Scan *, unsigned int);
+	static bool load(const char *, Engine *, Sink *, Scan *, unsigned int &);
+	static unsigned long size(const char *);
+	static bool resumesOutput(const char *, long &);
+};
+
+#endif /*CHECKPOINT_H_*/
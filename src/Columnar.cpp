@@ -0,0 +1,295 @@
+//Title: Columnar.cpp 
+//Description: Binary columnar output of annotated locations (row groups of delta/varint encoded columns, optionally compressed with zstd), along with a reader for downstream analytics.
+//             Loading such a file involves no text parsing, as columns are decoded directly into arrays.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "Columnar.h"
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+
+//Remove all rows from a row group
+void ColumnarRowGroup::clear()
+{
+    id.clear();
+    lon.clear();
+    lat.clear();
+    t.clear();
+    speed.clear();
+    heading.clear();
+    annotation.clear();
+}
+
+
+//Constructor; writes the file header
+ColumnarWriter::ColumnarWriter(const char *fileName, bool includeId)
+{
+    fout.open(fileName, ios::out | ios::binary);
+    this->includeId = includeId;
+
+    char magic[8] = COLUMNAR_MAGIC;
+    unsigned int flags = includeId ? 1 : 0;
+    fout.write(magic, sizeof(magic));
+    fout.write((const char *)&flags, sizeof(flags));
+}
+
+
+//Destructor
+ColumnarWriter::~ColumnarWriter()
+{
+    close();
+}
+
+
+//Append a location to the current row group; full row groups are written into the file
+void ColumnarWriter::append(Location *p)
+{
+    if (includeId)
+        rows.id.push_back(p->oid);
+    rows.lon.push_back(p->x);
+    rows.lat.push_back(p->y);
+    rows.t.push_back(p->t);
+    rows.speed.push_back(p->speed);
+    rows.heading.push_back(p->heading);
+    rows.annotation.push_back((unsigned short)(p->annotation.to_ulong() & ((1 << 10) - 1)));
+
+    if (rows.size() >= COLUMNAR_ROW_GROUP)
+        writeRowGroup();
+}
+
+
+//Write any pending rows and the terminator of the file; false if the file could not be written completely
+bool ColumnarWriter::close()
+{
+    if (fout.is_open()) {
+        writeRowGroup();
+        unsigned int numRows = 0;
+        fout.write((const char *)&numRows, sizeof(numRows));
+        fout.close();
+    }
+    return fout.good();
+}
+
+
+//Write all rows of the current row group, column by column
+void ColumnarWriter::writeRowGroup()
+{
+    unsigned int numRows = rows.size();
+    if (numRows == 0)
+        return;
+
+    fout.write((const char *)&numRows, sizeof(numRows));
+
+    if (includeId) {
+        values.assign(rows.id.begin(), rows.id.end());
+        writeIntegers(ENCODING_DELTA);
+    }
+    writeDoubles(rows.lon);
+    writeDoubles(rows.lat);
+    values.assign(rows.t.begin(), rows.t.end());
+    writeIntegers(ENCODING_DELTA);
+    writeDoubles(rows.speed);
+    writeDoubles(rows.heading);
+    values.assign(rows.annotation.begin(), rows.annotation.end());
+    writeIntegers(ENCODING_VARINT);
+
+    rows.clear();
+}
+
+
+//Encode the integer values of a column as varints (of zigzag differences between successive values, if ENCODING_DELTA or ENCODING_FIXED)
+void ColumnarWriter::writeIntegers(unsigned int encoding)
+{
+    encoded.clear();
+    unsigned long prev = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        unsigned long v = (unsigned long)values[i];
+        if (encoding != ENCODING_VARINT) {
+            long d = (long)(v - prev);
+            prev = v;
+            v = zigzag(d);
+        }
+        appendVarint(encoded, v);
+    }
+    writeColumn(encoding);
+}
+
+
+//Encode a column of doubles as fixed-point integers with PRECISION decimal digits, or as raw values if some cannot be printed exactly from such integers
+void ColumnarWriter::writeDoubles(vector<double> &column)
+{
+    values.resize(column.size());
+    for (size_t i = 0; i < column.size(); i++) {
+        if (!toFixedPoint(column[i], values[i]))
+            break;
+        if (i + 1 == column.size()) {
+            writeIntegers(ENCODING_FIXED);
+            return;
+        }
+    }
+
+    encoded.assign((const char *)column.data(), column.size() * sizeof(double));
+    writeColumn(ENCODING_DOUBLE);
+}
+
+
+//Write the encoded contents of a column, compressed if zstd is available
+void ColumnarWriter::writeColumn(unsigned int encoding)
+{
+    unsigned int codec = CODEC_RAW;
+    unsigned long encodedSize = encoded.size();
+    unsigned long storedSize = encodedSize;
+    const char *stored = encoded.data();
+
+#ifdef USE_ZSTD
+    packed.resize(ZSTD_compressBound(encodedSize));
+    size_t n = ZSTD_compress(&packed[0], packed.size(), encoded.data(), encodedSize, 3);
+    if (!ZSTD_isError(n) && (n < encodedSize)) {
+        codec = CODEC_ZSTD;
+        storedSize = n;
+        stored = packed.data();
+    }
+#endif
+
+    fout.write((const char *)&encoding, sizeof(encoding));
+    fout.write((const char *)&codec, sizeof(codec));
+    fout.write((const char *)&encodedSize, sizeof(encodedSize));
+    fout.write((const char *)&storedSize, sizeof(storedSize));
+    fout.write(stored, storedSize);
+}
+
+
+//Constructor; checks the file header
+ColumnarReader::ColumnarReader(const char *fileName)
+{
+    fin.open(fileName, ios::in | ios::binary);
+
+    char magic[8];
+    unsigned int flags = 0;
+    valid = (fin.read(magic, sizeof(magic)) && (strcmp(magic, COLUMNAR_MAGIC) == 0) && fin.read((char *)&flags, sizeof(flags)));
+    hasId = (flags & 1);
+}
+
+
+//Destructor
+ColumnarReader::~ColumnarReader()
+{
+    fin.close();
+}
+
+
+//Check whether this is a valid columnar file (or no errors occurred while reading it)
+bool ColumnarReader::good()
+{
+    return valid;
+}
+
+
+//Check whether identifiers are included in this file
+bool ColumnarReader::includesId()
+{
+    return hasId;
+}
+
+
+//Read the next row group; false once the file is exhausted (or not valid)
+bool ColumnarReader::next(ColumnarRowGroup &rows)
+{
+    rows.clear();
+
+    unsigned int numRows = 0;
+    if (!valid || !fin.read((char *)&numRows, sizeof(numRows)) || (numRows == 0))
+        return false;
+
+    unsigned int encoding;
+    if (hasId) {
+        valid = valid && readIntegers(numRows, encoding) && (encoding == ENCODING_DELTA);
+        rows.id.assign(values.begin(), values.end());
+    }
+    rows.lon.resize(numRows);
+    rows.lat.resize(numRows);
+    rows.speed.resize(numRows);
+    rows.heading.resize(numRows);
+    valid = valid && readDoubles(rows.lon) && readDoubles(rows.lat);
+    valid = valid && readIntegers(numRows, encoding) && (encoding == ENCODING_DELTA);
+    rows.t.assign(values.begin(), values.end());
+    valid = valid && readDoubles(rows.speed) && readDoubles(rows.heading);
+    valid = valid && readIntegers(numRows, encoding) && (encoding == ENCODING_VARINT);
+    rows.annotation.assign(values.begin(), values.end());
+
+    if (!valid)
+        rows.clear();
+    return valid;
+}
+
+
+//Read the encoded contents of the next column with the given number of values, decompressing them if needed
+//Integer columns are decoded into the buffer of values; doubles are left encoded
+bool ColumnarReader::readIntegers(size_t count, unsigned int &encoding)
+{
+    unsigned int codec;
+    unsigned long encodedSize, storedSize;
+    if (!fin.read((char *)&encoding, sizeof(encoding)) || !fin.read((char *)&codec, sizeof(codec)) || !fin.read((char *)&encodedSize, sizeof(encodedSize)) || !fin.read((char *)&storedSize, sizeof(storedSize)))
+        return false;
+
+    encoded.resize(encodedSize);
+    if (codec == CODEC_RAW) {
+        if ((storedSize != encodedSize) || !fin.read(&encoded[0], encodedSize))
+            return false;
+    }
+#ifdef USE_ZSTD
+    else if (codec == CODEC_ZSTD) {
+        packed.resize(storedSize);
+        if (!fin.read(&packed[0], storedSize) || (ZSTD_decompress(&encoded[0], encodedSize, packed.data(), storedSize) != encodedSize))
+            return false;
+    }
+#endif
+    else {
+        cerr << "Column compressed with unsupported codec " << codec << " (rebuild with ZSTD=yes)." << endl;
+        return false;
+    }
+
+    if (encoding == ENCODING_DOUBLE)
+        return (encodedSize == count * sizeof(double));
+
+    //Decode varints (and zigzag differences)
+    values.resize(count);
+    const unsigned char *c = (const unsigned char *)encoded.data();
+    const unsigned char *end = c + encodedSize;
+    unsigned long prev = 0;
+    for (size_t i = 0; i < count; i++) {
+        unsigned long v;
+        if (!readVarint(c, end, v))
+            return false;
+        if (encoding != ENCODING_VARINT) {
+            v = prev + (unsigned long)unzigzag(v);
+            prev = v;
+        }
+        values[i] = (long)v;
+    }
+    return (c == end);
+}
+
+
+//Read the next column of doubles, either fixed-point or raw
+bool ColumnarReader::readDoubles(vector<double> &column)
+{
+    unsigned int encoding;
+    if (!readIntegers(column.size(), encoding))
+        return false;
+
+    if (encoding == ENCODING_DOUBLE) {
+        memcpy(column.data(), encoded.data(), column.size() * sizeof(double));
+        return true;
+    }
+    if (encoding != ENCODING_FIXED)
+        return false;
+
+    for (size_t i = 0; i < column.size(); i++)
+        column[i] = fromFixedPoint(values[i]);
+    return true;
+}
@@ -0,0 +1,187 @@
+#ifndef COLUMNAR_H_
+#define COLUMNAR_H_
+
+#include "Location.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <climits>
+
+using namespace std;
+
+
+//Binary columnar file format for annotated locations
+//Layout: file header, then a sequence of row groups, then an empty row group as terminator (all numbers in little-endian byte order)
+//  File header: magic "AISCOL1" (8 bytes, zero-terminated), flags (uint32: bit 0 set if identifiers are included)
+//  Row group: number of rows (uint32), then each column as: encoding (uint32), codec (uint32), encoded size (uint64), stored size (uint64), stored bytes
+//  Columns: id (only if identifiers are included), lon, lat, t, speed, heading, annotation bitmask (bits 0-9)
+//Encodings:
+//  ENCODING_DELTA: integers as zigzag varints of differences between successive values (identifiers, timestamps)
+//  ENCODING_FIXED: doubles as integers with PRECISION decimal digits (exactly as printed in the text output), encoded like ENCODING_DELTA
+//  ENCODING_DOUBLE: doubles as raw 8-byte values; only if some value in the row group cannot be printed exactly from a fixed-point one
+//  ENCODING_VARINT: integers as varints (annotations)
+//Codecs: CODEC_RAW for encoded bytes as is; CODEC_ZSTD for encoded bytes compressed with zstd (if available at compile time with USE_ZSTD)
+//Hence, a conversion back to text yields exactly the same output as the text sink
+#define COLUMNAR_MAGIC "AISCOL1"
+#define COLUMNAR_ROW_GROUP 65536	//Number of rows per row group
+#define ENCODING_DELTA 0
+#define ENCODING_FIXED 1
+#define ENCODING_DOUBLE 2
+#define ENCODING_VARINT 3
+#define CODEC_RAW 0
+#define CODEC_ZSTD 1
+
+
+//Scale the absolute value of a double number to an integer with PRECISION decimal digits, rounded exactly as when printing it with setprecision(PRECISION) and fixed
+//False if the value is not finite, too large, or too close to a rounding tie to be safely rounded by scaling; then, it must be left to the standard conversion
+inline bool scaleToPrecision(double v, unsigned long &q)
+{
+	static const double scale = pow(10.0, PRECISION);
+
+	double a = fabs(v) * scale;
+	if (!(a < 1.0e11) || (fabs(a - floor(a) - 0.5) <= 1.0e-4))
+		return false;
+	q = (unsigned long)llround(a);
+	return true;
+}
+
+
+//Fixed-point integer with PRECISION decimal digits of a double number, printed exactly as the number itself in the text output; false if there is none (e.g., not finite or too large)
+//CAUTION! Negative values rounded to zero keep their sign in the text output (e.g., "-0.00000"); these are given as the minimum integer
+inline bool toFixedPoint(double v, long &f)
+{
+	unsigned long q;
+	if (!scaleToPrecision(v, q)) {
+		//Near a rounding tie, take the digits from the standard conversion
+		if (!std::isfinite(v) || (fabs(v) >= 1.0e6))
+			return false;
+		char text[400];
+		snprintf(text, sizeof(text), "%.*f", PRECISION, fabs(v));
+		char *dot = strchr(text, '.');
+		if (dot != NULL)
+			memmove(dot, dot + 1, strlen(dot));
+		q = strtoul(text, NULL, 10);
+	}
+	if (std::signbit(v))
+		f = (q == 0) ? LONG_MIN : -(long)q;
+	else
+		f = (long)q;
+	return true;
+}
+
+
+//Double number of a fixed-point integer with PRECISION decimal digits
+inline double fromFixedPoint(long f)
+{
+	static const double scale = pow(10.0, PRECISION);
+
+	return (f == LONG_MIN) ? -0.0 : f / scale;
+}
+
+
+//Append an unsigned integer as a varint (7 bits per byte, least significant first)
+inline void appendVarint(string &encoded, unsigned long v)
+{
+	while (v >= 0x80) {
+		encoded += (char)((v & 0x7F) | 0x80);
+		v >>= 7;
+	}
+	encoded += (char)v;
+}
+
+
+//Decode the next varint, advancing past it; false if it is truncated
+inline bool readVarint(const unsigned char *&c, const unsigned char *end, unsigned long &v)
+{
+	v = 0;
+	for (int shift = 0; ; shift += 7) {
+		if ((c == end) || (shift > 63))
+			return false;
+		v |= (unsigned long)(*c & 0x7F) << shift;
+		if ((*c++ & 0x80) == 0)
+			return true;
+	}
+}
+
+
+//Zigzag encoding of a signed difference, so that small differences of either sign become small numbers
+inline unsigned long zigzag(long d)
+{
+	return ((unsigned long)d << 1) ^ (unsigned long)(d >> 63);
+}
+
+
+//Signed difference of a zigzag encoded number
+inline long unzigzag(unsigned long v)
+{
+	return (long)(v >> 1) ^ -(long)(v & 1);
+}
+
+
+//A group of consecutive rows, stored column by column
+struct ColumnarRowGroup {
+	vector<long> id;
+	vector<double> lon;
+	vector<double> lat;
+	vector<unsigned int> t;
+	vector<double> speed;
+	vector<double> heading;
+	vector<unsigned short> annotation;
+
+	size_t size() { return t.size(); }
+	void clear();
+};
+
+
+//Class for writing annotated locations into a binary columnar file; columns are compressed with zstd if available at compile time (USE_ZSTD)
+class ColumnarWriter {
+public:
+	ColumnarWriter(const char *, bool);
+	~ColumnarWriter();
+
+	void append(Location *);
+	bool close();
+
+private:
+	ofstream fout;
+	bool includeId;
+	ColumnarRowGroup rows;		//Rows in the current row group
+	vector<long> values;		//Reusable buffer for integer values of a column
+	string encoded;			//Reusable buffer for encoded columns
+	string packed;			//Reusable buffer for compressed columns
+
+	void writeRowGroup();
+	void writeIntegers(unsigned int);
+	void writeDoubles(vector<double> &);
+	void writeColumn(unsigned int);
+};
+
+
+//Class for reading a binary columnar file row group by row group
+class ColumnarReader {
+public:
+	ColumnarReader(const char *);
+	~ColumnarReader();
+
+	bool good();
+	bool includesId();
+	bool next(ColumnarRowGroup &);
+
+private:
+	ifstream fin;
+	bool valid;
+	bool hasId;
+	vector<long> values;		//Reusable buffer for integer values of a column
+	string encoded;			//Reusable buffer for encoded columns
+	string packed;			//Reusable buffer for compressed columns
+
+	bool readIntegers(size_t, unsigned int &);
+	bool readDoubles(vector<double> &);
+};
+
+#endif /*COLUMNAR_H_*/
@@ -12,6 +12,7 @@ using namespace std;
 #define PRECISION 5			//Number of decimal points when reporting double numbers
 #define EPSILON 0.000001                //Epsilon tolerance when comparing double numbers
 #define SLIDE 600                       //Window slide (in seconds) only for consuming input data in batches (every SLIDE seconds)
+#define OUTPUT_BUFFER_SIZE 1048576       //Size (in bytes) of the buffer where output rows are formatted before being written into file
 
 
 //Class for maintaining incoming point locations of a moving object along with their annotations based on its motion pattern
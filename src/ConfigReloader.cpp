@@ -0,0 +1,143 @@
+//Title: ConfigReloader.cpp
+//Description: Hot reload of the configuration settings per vessel type, without restarting the stream or losing any vessel states.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "ConfigReloader.h"
+#include <sys/stat.h>
+#include <chrono>
+
+
+volatile sig_atomic_t ConfigReloader::signalled = 0;
+
+
+//Constructor; the given table holds the settings initially parsed from the file
+ConfigReloader::ConfigReloader(char *fileName, map< string, Config* > *initial, map< string, Config* > (*parse)(char *))
+{
+    this->fileName = fileName;
+    this->parse = parse;
+    this->table.store(initial);
+    this->numVersions.store(0);
+    this->parseTime.store(0);
+    this->publishTime.store(0);
+    this->tables.push_back(initial);
+    this->modified = lastModified();
+    this->running = false;
+}
+
+
+//Destructor; releases all tables published by the reloader (but not the initial one)
+ConfigReloader::~ConfigReloader()
+{
+    stop();
+    for (size_t i = 1; i < tables.size(); i++) {
+        for (map< string, Config* >::iterator it = tables[i]->begin(); it != tables[i]->end(); it++)
+            delete it->second;
+        delete tables[i];
+    }
+}
+
+
+//Start watching the file for changes and handling SIGHUP
+void ConfigReloader::start()
+{
+    running = true;
+    signal(SIGHUP, ConfigReloader::requestReload);
+    watcher = std::thread(&ConfigReloader::watch, this);
+}
+
+
+//Stop watching the file
+void ConfigReloader::stop()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        running = false;
+    }
+    wakeup.notify_all();
+    if (watcher.joinable())
+        watcher.join();
+}
+
+
+//Signal handler: only flags a reload, which is carried out by the watcher thread
+void ConfigReloader::requestReload(int)
+{
+    signalled = 1;
+}
+
+
+//Modification time (in nanoseconds) of the file; zero if it cannot be accessed
+long ConfigReloader::lastModified()
+{
+    struct stat st;
+    if (stat(fileName.c_str(), &st) != 0)
+        return 0;
+    return (long)st.st_mtim.tv_sec * 1000000000L + st.st_mtim.tv_nsec;
+}
+
+
+//Watcher thread: poll for a signal or a newer version of the file, parse it and publish the resulting table
+//If the file cannot be parsed (e.g., while being edited), the current table is kept
+void ConfigReloader::watch()
+{
+    unique_lock<mutex> guard(lock);
+    while (running) {
+        wakeup.wait_for(guard, std::chrono::milliseconds(200));
+        if (!running)
+            break;
+
+        long m = lastModified();
+        if (!signalled && ((m == modified) || (m == 0)))
+            continue;
+        signalled = 0;
+        modified = m;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        map< string, Config* > *configs;
+        try {
+            configs = new map< string, Config* >(parse((char *)fileName.c_str()));
+        }
+        catch (const std::exception &e) {
+            cerr << "Settings not reloaded from " << fileName << ": " << e.what() << endl;
+            continue;
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        tables.push_back(configs);
+        parseTime.store(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+        publishTime.store(std::chrono::duration_cast<std::chrono::microseconds>(end.time_since_epoch()).count());
+        table.store(configs, std::memory_order_release);
+        numVersions.fetch_add(1, std::memory_order_release);
+    }
+}
+
+
+//Latest table of settings
+map< string, Config* >* ConfigReloader::current()
+{
+    return table.load(std::memory_order_acquire);
+}
+
+
+//Number of tables published after the initial one; a new value signifies a new table
+unsigned int ConfigReloader::version()
+{
+    return numVersions.load(std::memory_order_acquire);
+}
+
+
+//Time (in microseconds) taken to parse the latest table
+unsigned long ConfigReloader::latency()
+{
+    return parseTime.load();
+}
+
+
+//Time (in microseconds) elapsed since the latest table was published
+unsigned long ConfigReloader::elapsed()
+{
+    unsigned long now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    return now - publishTime.load();
+}
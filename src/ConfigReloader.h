@@ -0,0 +1,53 @@
+#ifndef CONFIGRELOADER_H_
+#define CONFIGRELOADER_H_
+
+#include "Config.h"
+#include <map>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <signal.h>
+
+using namespace std;
+
+
+//Class for reloading the configuration settings per vessel type while the stream is being consumed, whenever the JSON file changes or SIGHUP is received
+//A watcher thread parses the file off the processing path and publishes the new table of settings with an atomic pointer swap
+//Tables are never released before the reloader itself, as states may keep referring to the settings of an earlier table until their next update
+class ConfigReloader {
+public:
+	ConfigReloader(char *, map< string, Config* > *, map< string, Config* > (*)(char *));
+	~ConfigReloader();
+
+	void start();
+	void stop();
+	map< string, Config* >* current();
+	unsigned int version();
+	unsigned long latency();
+	unsigned long elapsed();
+	static void requestReload(int);
+
+private:
+	string fileName;
+	map< string, Config* > (*parse)(char *);	//Parser of the JSON file into settings per vessel type
+	atomic< map< string, Config* >* > table;	//Latest table of settings
+	atomic<unsigned int> numVersions;		//Number of tables published after the initial one
+	atomic<unsigned long> parseTime;		//Time (in microseconds) taken to parse the latest table
+	atomic<unsigned long> publishTime;		//Time (in microseconds on the steady clock) when the latest table was published
+	vector< map< string, Config* >* > tables;	//All tables published, including the initial one (not owned)
+	long modified;					//Modification time (in nanoseconds) of the file when last parsed
+	static volatile sig_atomic_t signalled;		//Set by the signal handler; cleared by the watcher
+
+	std::thread watcher;
+	mutex lock;
+	condition_variable wakeup;
+	bool running;
+
+	void watch();
+	long lastModified();
+};
+
+#endif /*CONFIGRELOADER_H_*/
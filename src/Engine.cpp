@@ -0,0 +1,320 @@
+//Title: Engine.cpp 
+//Description: Annotates incoming tuples by maintaining the state of each vessel and applying mobility checks to its fresh locations.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "Engine.h"
+#include "Checkpoint.h"
+#include "Metrics.h"
+
+
+//Constructor
+Engine::Engine(map< string, Config* > *configs, VesselRegistry *info, Sink *sink)
+{
+    this->vesselTypeConfigs = configs;
+    this->configVersion = 0;
+    this->vesselInfo = info;
+    info->bind(configs, typeConfigs);
+    this->sinkStream = sink;
+    this->groupByVessel = false;
+    this->proactive = false;
+    this->horizon = 0;
+}
+
+
+//Destructor; releases states of all objects
+Engine::~Engine()
+{
+    for (map< long, State* >::iterator iterState = trajStates.begin(); iterState != trajStates.end(); iterState++)
+        delete iterState->second;
+}
+
+
+//Get configuration settings according to the type of the given vessel (default settings if its type is unknown)
+Config* Engine::getConfig(long oid)
+{
+    return typeConfigs[vesselInfo->typeOf(oid)];
+}
+
+
+//State for a NEW object, configured according to the type of the vessel
+State* Engine::createState(long oid, unsigned int t)
+{
+    Config *config = this->getConfig(oid);
+    State *s = new State(oid, t, config, sinkStream);
+    if (configVersion > 0)
+        s->setConfig(config, configVersion);
+    return s;
+}
+
+
+//Replace the configurations per vessel type (e.g., once reloaded); each object already monitored switches to the new settings upon its next location
+//CAUTION! The previous configurations must not be released, as states keep referring to them until their next update
+void Engine::reconfigure(map< string, Config* > *configs)
+{
+    vesselTypeConfigs = configs;
+    vesselInfo->bind(configs, typeConfigs);
+    configVersion++;
+}
+
+
+//Process a batch of incoming tuples
+void Engine::process(vector<Location *> &inTuples)
+{
+    if ((proactive || (horizon > 0)) && !inTuples.empty())
+        expireStates(inTuples);
+
+    //Keep all updates of the same vessel together while its state is hot in cache
+    if (groupByVessel)
+        groupByObject(inTuples, groupBuffer);
+
+    for (vector<Location *>::iterator it = inTuples.begin(); it != inTuples.end(); it++)
+        this->process(*it);
+}
+
+
+//UPDATE: Refresh object location and update its state
+void Engine::process(Location *p)
+{
+    //Any locations reported from now on are attributed to this tuple
+    sinkStream->setTrigger(p->seq);
+
+    //Get trajectory already maintained for this object
+    map< long, State* >::iterator iterState = trajStates.find(p->oid);   
+    if (iterState == trajStates.end()) {     //No state available for this object
+        State *newState = this->createState(p->oid, p->t);
+        newState->init(p);
+        iterState = trajStates.insert(pair< long, State* >(p->oid, newState)).first;
+    }
+    else {
+        //Pick up settings reloaded since the latest update of this object
+        if (iterState->second->getConfigVersion() != configVersion)
+            iterState->second->setConfig(this->getConfig(p->oid), configVersion);
+
+        //Report locations retained beyond the horizon, unless a timer has already done so
+        if ((horizon > 0) && (iterState->second->getFinality(horizon) <= p->t)) {
+            iterState->second->finalize(p->t, horizon);
+            sinkStream->setTrigger(p->seq);
+        }
+
+        //Remove any obsolete locations from the state
+        iterState->second->expungeObsoleteLocations(p->t);
+        //Update state with fresh location
+        if (iterState->second->isEmpty()) { //state is empty, possibly because of a communication gap
+            iterState->second->init(p);
+        }
+        else {   //Update state and annotate locations accordingly
+            iterState->second->update(p);
+        }
+    }
+
+    if (proactive || (horizon > 0))
+        schedule(iterState->second);
+    track(p->oid, iterState->second);
+}
+
+
+//Expire the states of objects that went silent before the earliest timestamp in a batch (if proactive), and report the locations retained beyond the horizon before it
+//Locations reported upon expiry are attributed to the first tuple of the batch; those beyond the horizon are reported just as upon the next location of their object, so results do not depend on batches
+//CAUTION! No tuple in this batch or any later one may precede this timestamp, i.e., the input must be in chronological order
+void Engine::expireStates(vector<Location *> &inTuples)
+{
+    unsigned int tMin = UINT_MAX;
+    for (vector<Location *>::iterator it = inTuples.begin(); it != inTuples.end(); it++)
+        tMin = min(tMin, (*it)->t);
+
+    timers.advance(tMin, expired);
+    for (vector< pair<unsigned int, State*> >::iterator it = expired.begin(); it != expired.end(); it++) {
+        State *s = it->second;
+        if (s->getTimer() != it->first)      //Superseded by an earlier timer of the same state
+            continue;
+        s->setTimer(UINT_MAX);
+        if (proactive) {
+            sinkStream->setTrigger(inTuples.front()->seq);
+            s->expire(tMin);
+        }
+        if (horizon > 0)
+            s->finalize(tMin, horizon);
+        schedule(s);
+    }
+}
+
+
+//Schedule a timer at the expiry of a state (if proactive) or once its locations become final by the horizon, unless an earlier one is already scheduled
+//Timers are not rescheduled whenever a state is updated; once an outdated timer fires, the state is only expired if due, and a timer is scheduled at its current expiry
+void Engine::schedule(State *s)
+{
+    unsigned int expiry = proactive ? s->getExpiry() : UINT_MAX;
+    if (horizon > 0)
+        expiry = min(expiry, s->getFinality(horizon));
+    if (expiry < s->getTimer()) {
+        timers.schedule(expiry, s);
+        s->setTimer(expiry);
+    }
+}
+
+
+//Once the stream is exhausted, expunge any remaining positions from the last state of each sequence
+void Engine::close()
+{
+    for (map< long, State* >::iterator iterState = trajStates.begin(); iterState != trajStates.end(); iterState++) { 
+        //Mark the last point as GAP_START and report all locations to the output
+        sinkStream->setTrigger(Sink::endOfStream(iterState->first));
+        iterState->second->markLastLocationAsGap();    
+    }
+}
+
+
+//Identifiers of all objects currently monitored
+void Engine::listObjects(vector<long> &objects)
+{
+    for (map< long, State* >::iterator iterState = trajStates.begin(); iterState != trajStates.end(); iterState++)
+        objects.push_back(iterState->first);
+}
+
+
+//Fingerprints of the current states of all monitored objects
+void Engine::fingerprints(map< long, string > &prints)
+{
+    for (map< long, State* >::iterator iterState = trajStates.begin(); iterState != trajStates.end(); iterState++)
+        prints[iterState->first] = iterState->second->fingerprint();
+}
+
+
+//Stop monitoring an object and hand over its state (if any)
+//CAUTION! Not to be used with proactive expiry, since a timer may still be scheduled for the state
+State* Engine::release(long oid)
+{
+    map< long, State* >::iterator iterState = trajStates.find(oid);
+    if (iterState == trajStates.end())
+        return NULL;
+
+    State *s = iterState->second;
+    trajStates.erase(iterState);
+    return s;
+}
+
+
+//Take over the state of an object (e.g., from another engine), replacing any state already maintained for it
+void Engine::adopt(long oid, State *s)
+{
+    s->setSink(sinkStream);
+    s->setLowerBound(UINT_MAX);     //Not tracked by this engine yet
+
+    map< long, State* >::iterator iterState = trajStates.find(oid);
+    if (iterState != trajStates.end()) {
+        delete iterState->second;
+        iterState->second = s;
+    }
+    else
+        trajStates.insert(pair< long, State* >(oid, s));
+    track(oid, s);
+}
+
+
+//Append the states of all monitored objects to a snapshot
+void Engine::save(string &buf)
+{
+    unsigned long n = trajStates.size();
+    putValue(buf, n);
+    for (map< long, State* >::iterator iterState = trajStates.begin(); iterState != trajStates.end(); iterState++) {
+        putValue(buf, iterState->first);
+        iterState->second->save(buf);
+    }
+}
+
+
+//Restore the states of objects from a snapshot; each state is bound to the current configuration for the type of its vessel (and scheduled for expiry, if proactive)
+bool Engine::load(const char *&p, const char *end)
+{
+    unsigned long n;
+    if (!getValue(p, end, n))
+        return false;
+
+    for (unsigned long i = 0; i < n; i++) {
+        long oid;
+        if (!getValue(p, end, oid))
+            return false;
+        State *s = this->createState(oid, 0);
+        if (!s->load(p, end)) {
+            delete s;
+            return false;
+        }
+        trajStates.insert(trajStates.end(), pair< long, State* >(oid, s));     //States are saved in ascending identifiers
+        if (proactive || (horizon > 0))
+            schedule(s);
+        track(oid, s);
+    }
+    return true;
+}
+
+
+//Timestamp of the oldest location retained in any state; locations reported before it cannot change any more
+//States are kept in a heap by a lower bound on their oldest timestamp, which is only refreshed once on top; hence, the cost is logarithmic per state whose oldest location changed since
+unsigned int Engine::oldestTimestamp()
+{
+    while (!oldest.empty()) {
+        pair<unsigned int, long> top = oldest.top();
+        map< long, State* >::iterator iterState = trajStates.find(top.second);
+        if ((iterState == trajStates.end()) || (iterState->second->getLowerBound() != top.first)) {    //Object released, or outdated entry
+            oldest.pop();
+            continue;
+        }
+
+        State *s = iterState->second;
+        if (s->getOldestTimestamp() == top.first)
+            return top.first;
+        oldest.pop();
+        s->setLowerBound(UINT_MAX);
+        track(top.second, s);       //Refresh its bound, unless the state is now empty
+    }
+    return UINT_MAX;
+}
+
+
+//Keep a state in the heap of oldest timestamps, unless it is empty or already kept there by a lower bound (any previous entry becomes outdated otherwise)
+void Engine::track(long oid, State *s)
+{
+    unsigned int t = s->getOldestTimestamp();
+    if (t >= s->getLowerBound())
+        return;
+    oldest.push(pair<unsigned int, long>(t, oid));
+    s->setLowerBound(t);
+}
+
+
+//Number of objects monitored
+unsigned int Engine::countStates()
+{
+    return trajStates.size();
+}
+
+
+//Number of locations retained in all states
+unsigned long Engine::countLocations()
+{
+    unsigned long k = 0;
+    for (map< long, State* >::iterator iterState = trajStates.begin(); iterState != trajStates.end(); iterState++)
+        k += iterState->second->countLocations();
+    return k;
+}
+
+
+//Add the memory held by all states to the given usage, along with the lengths of their histories; stopped objects pinning unusually long histories are listed with their lengths
+void Engine::measure(MemoryUsage &m, vector< pair<long, unsigned int> > &pinned)
+{
+    for (map< long, State* >::iterator iterState = trajStates.begin(); iterState != trajStates.end(); iterState++) {
+        State *s = iterState->second;
+        unsigned long n = s->countLocations();
+        m.stateLocations += n;
+        m.stateBytes += MAP_NODE_BYTES + sizeof(pair< const long, State* >) + sizeof(State) + n * (sizeof(Location) + LIST_NODE_BYTES + sizeof(Location*));
+        m.histories[MemoryUsage::historyBucket(n)]++;
+        m.maxHistory = std::max(m.maxHistory, n);
+        if (s->isPinning()) {
+            m.numPinned++;
+            m.pinnedLocations += n;
+            pinned.push_back(pair< long, unsigned int >(iterState->first, n));
+        }
+    }
+}
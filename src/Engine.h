@@ -0,0 +1,59 @@
+#ifndef ENGINE_H_
+#define ENGINE_H_
+
+#include "State.h"
+#include "TimerWheel.h"
+#include "VesselRegistry.h"
+
+using namespace std;
+
+struct MemoryUsage;
+
+
+//Class for annotating a stream of tuples by maintaining the states of all vessels monitored in a partition of the stream
+class Engine {
+public:
+	Engine(map< string, Config* > *, VesselRegistry *, Sink *);
+	~Engine();
+
+	void process(vector<Location *> &);
+	void process(Location *);
+	void close();
+
+	void listObjects(vector<long> &);
+	void fingerprints(map< long, string > &);
+	State* release(long);
+	void adopt(long, State *);
+	void reconfigure(map< string, Config* > *);
+	void save(string &);
+	bool load(const char *&, const char *);
+
+	unsigned int oldestTimestamp();
+	unsigned int countStates();
+	unsigned long countLocations();
+	void measure(MemoryUsage &, vector< pair<long, unsigned int> > &);
+	bool groupByVessel;		//Process each batch grouped by vessel (in arrival order per vessel)
+	bool proactive;			//Expire the states of silent objects as the stream advances, instead of upon their next location
+	unsigned int horizon;		//Locations are final once retained for this long (in seconds of event time) in a state, e.g., of a long stop or a silent object; zero if unbounded
+
+private:
+	map< long, State* > trajStates;		//Retain the states per trajectory
+	map< string, Config* > *vesselTypeConfigs;	//User-specified configurations per vessel type
+	unsigned int configVersion;		//Number of times the configurations have been replaced
+	VesselRegistry *vesselInfo;		//Vessel type per MMSI
+	vector<Config *> typeConfigs;		//Configuration per dense index of vessel type
+	Sink *sinkStream;			//Collects the reported locations
+	vector<Location *> groupBuffer;		//Auxiliary buffer for grouping batches by vessel
+
+	TimerWheel<State*> timers;		//Expiry of states by event time; only if proactive or with a horizon
+	vector< pair<unsigned int, State*> > expired;	//Auxiliary buffer for timers fired in a batch
+	priority_queue< pair<unsigned int, long>, vector< pair<unsigned int, long> >, greater< pair<unsigned int, long> > > oldest;	//Lower bound on the oldest timestamp of each state (and its object), refreshed once on top
+
+	Config* getConfig(long);
+	State* createState(long, unsigned int);
+	void expireStates(vector<Location *> &);
+	void schedule(State *);
+	void track(long, State *);
+};
+
+#endif /*ENGINE_H_*/
@@ -0,0 +1,156 @@
+//Title: Filter.cpp
+//Description: Predicates on the locations emitted by a sink (annotations, time range, vessel types, bounding box, polygon), so that unwanted rows are never formatted nor written.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "Filter.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+
+//Constructor; initially, all locations qualify
+Filter::Filter()
+{
+    mask = 0;
+    hasTimeRange = false;
+    tMin = 0;
+    tMax = 0;
+    hasTypes = false;
+    registry = NULL;
+    hasBox = false;
+    minX = minY = maxX = maxY = 0.0;
+}
+
+
+//Specify annotations of interest as a comma separated list of names (e.g., "STOP_START,GAP_END"); a trailing '*' matches all names with that prefix (e.g., "STOP_*")
+//A location qualifies if it bears at least one of these annotations; false if some name does not match any annotation
+bool Filter::setAnnotations(string names)
+{
+    static const char* annotations[] = { "STOP_START", "STOP_END", "CHANGE_IN_SPEED_START", "CHANGE_IN_SPEED_END", "SLOW_MOTION_START", "SLOW_MOTION_END", "GAP_START", "GAP_END", "CHANGE_IN_HEADING", "NOISE" };
+
+    stringstream ss(names);
+    string name;
+    while (getline(ss, name, ',')) {
+        bool prefix = (!name.empty() && (name.back() == '*'));
+        if (prefix)
+            name.pop_back();
+        unsigned long bits = 0;
+        for (unsigned int i = 0; i < 10; i++) {
+            string a = annotations[i];
+            if ((a == name) || (prefix && (a.compare(0, name.size(), name) == 0)))
+                bits |= (1UL << i);
+        }
+        if (bits == 0)
+            return false;
+        mask |= bits;
+    }
+    return true;
+}
+
+
+//Specify a bounding box of interest (inclusive); if a polygon is also given, locations must lie within both
+void Filter::setBoundingBox(double x1, double y1, double x2, double y2)
+{
+    if (hasBox) {       //Intersect with the bounding box of the polygon
+        minX = max(minX, min(x1, x2));
+        minY = max(minY, min(y1, y2));
+        maxX = min(maxX, max(x1, x2));
+        maxY = min(maxY, max(y1, y2));
+    }
+    else {
+        minX = min(x1, x2);
+        minY = min(y1, y2);
+        maxX = max(x1, x2);
+        maxY = max(y1, y2);
+    }
+    hasBox = true;
+}
+
+
+//Read a polygon of interest from a file with a vertex (lon lat, space delimited) per line; false if it has less than three vertices
+bool Filter::setPolygon(const char *fileName)
+{
+    ifstream fin(fileName);
+    string line;
+    double x, y;
+    vector< pair<double, double> > vertices;
+    while (getline(fin, line)) {
+        stringstream ss(line);
+        if (ss >> x >> y)
+            vertices.push_back(make_pair(x, y));
+    }
+    if (vertices.size() < 3)
+        return false;
+    polygon = vertices;
+
+    //Bounding box of the polygon, so that most locations are rejected without testing the polygon itself
+    double x1 = polygon[0].first, y1 = polygon[0].second, x2 = x1, y2 = y1;
+    for (unsigned int i = 1; i < polygon.size(); i++) {
+        x1 = min(x1, polygon[i].first);
+        y1 = min(y1, polygon[i].second);
+        x2 = max(x2, polygon[i].first);
+        y2 = max(y2, polygon[i].second);
+    }
+    setBoundingBox(x1, y1, x2, y2);
+    return true;
+}
+
+
+//Specify a range of timestamps of interest (inclusive)
+void Filter::setTimeRange(unsigned int t1, unsigned int t2)
+{
+    hasTimeRange = true;
+    tMin = min(t1, t2);
+    tMax = max(t1, t2);
+}
+
+
+//Specify vessel types of interest, resolved per type once with the given registry; vessels missing from it are of type "Default"
+void Filter::setVesselTypes(set<string> &types, VesselRegistry *info)
+{
+    hasTypes = true;
+    registry = info;
+    typesOfInterest.assign(info->countTypes(), false);
+    for (unsigned int k = 0; k < info->countTypes(); k++)
+        typesOfInterest[k] = (types.count(info->getTypeName(k)) > 0);
+}
+
+
+//Check whether a location satisfies all predicates
+bool Filter::accept(Location *p)
+{
+    if ((mask != 0) && ((p->annotation.to_ulong() & mask) == 0))
+        return false;
+
+    if (hasTimeRange && ((p->t < tMin) || (p->t > tMax)))
+        return false;
+
+    if (hasTypes) {
+        if (!typesOfInterest[registry->typeOf(p->oid)])
+            return false;
+    }
+
+    if (hasBox && ((p->x < minX) || (p->x > maxX) || (p->y < minY) || (p->y > maxY)))
+        return false;
+
+    if (!polygon.empty() && !insidePolygon(p->x, p->y))
+        return false;
+
+    return true;
+}
+
+
+//Point-in-polygon test by ray casting (even-odd rule)
+bool Filter::insidePolygon(double x, double y)
+{
+    bool inside = false;
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        double xi = polygon[i].first, yi = polygon[i].second;
+        double xj = polygon[j].first, yj = polygon[j].second;
+        if (((yi > y) != (yj > y)) && (x < (xj - xi) * (y - yi) / (yj - yi) + xi))
+            inside = !inside;
+    }
+    return inside;
+}
@@ -0,0 +1,43 @@
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include "Location.h"
+#include "VesselRegistry.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+using namespace std;
+
+
+//Class for declarative predicates on the locations emitted by a sink; only locations satisfying ALL specified predicates are written into the output
+//Predicates are checked in ascending order of cost (annotation bitmask, timestamp, vessel type, bounding box, polygon), before a location gets formatted
+class Filter {
+public:
+	Filter();
+
+	bool setAnnotations(string);
+	void setBoundingBox(double, double, double, double);
+	bool setPolygon(const char *);
+	void setTimeRange(unsigned int, unsigned int);
+	void setVesselTypes(set<string> &, VesselRegistry *);
+
+	bool accept(Location *);
+	unsigned long getAnnotationMask() { return mask; }
+
+private:
+	unsigned long mask;		//Annotations of interest (bits as in Location); zero if all locations qualify
+	bool hasTimeRange;
+	unsigned int tMin, tMax;	//Timestamps of interest (inclusive)
+	bool hasTypes;
+	VesselRegistry *registry;	//Vessel type per MMSI
+	vector<bool> typesOfInterest;	//Whether each vessel type (per dense index) is of interest
+	bool hasBox;
+	double minX, minY, maxX, maxY;	//Bounding box of interest, or bounding box of the polygon
+	vector< pair<double, double> > polygon;		//Vertices of a polygon of interest (lon, lat); empty if none
+
+	bool insidePolygon(double, double);
+};
+
+#endif /*FILTER_H_*/
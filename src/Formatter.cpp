@@ -0,0 +1,269 @@
+//Title: Formatter.cpp
+//Description: Formatting of annotated locations into ASCII rows of an output file.
+//             Numbers are converted in place and annotations come from a precomputed table, so that no row involves any heap allocation.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "Formatter.h"
+
+
+//Constructor
+//If includeTrigger is set, each row is prefixed with the ordering key of its report (e.g., in the output of a partition to be merged afterwards)
+Formatter::Formatter(bool includeId, bool includeTrigger)
+{
+    this->out = NULL;
+    this->async = NULL;
+    this->includeId = includeId;
+    this->includeTrigger = includeTrigger;
+    outBuffer = new char[OUTPUT_BUFFER_SIZE];
+    outLength = 0;
+}
+
+
+//Destructor
+Formatter::~Formatter()
+{
+    close();
+    if (async == NULL)
+        delete [] outBuffer;
+}
+
+
+//Direct subsequent rows into another stream; rows already formatted are written into the previous one
+void Formatter::setOutput(ostream *out)
+{
+    flush();
+    this->out = out;
+}
+
+
+//Direct all rows into a file written by a separate thread; formatting continues into the buffers of that writer (after any bytes already there, if it resumes a file)
+//CAUTION! Once set, the output cannot be changed any more
+void Formatter::setOutput(AsyncWriter *async)
+{
+    flush();
+    delete [] outBuffer;
+    outBuffer = async->getBuffer(outLength);
+    this->async = async;
+}
+
+
+//Header with column names of the output
+void Formatter::writeHeader()
+{
+    vector<string> fields;  //Output fields
+    if (this->includeId) {
+        fields = { "id", "lon", "lat", "t", "speed", "heading", "annotation" };  //MULTIPLE objects in single output file
+    }
+    else {
+        fields = { "lon", "lat", "t", "speed", "heading", "annotation" };  //SINGLE object
+    }
+    if (this->includeTrigger)
+        fields.insert(fields.begin(), "trigger");
+
+    const char delimiter = DELIMITER;
+    for (unsigned int i = 0; i < fields.size(); i++) {
+        appendText(fields[i].data(), fields[i].size());
+        if (i + 1 == fields.size())
+            appendText("\r\n", 2);
+        else
+            appendText(&delimiter, 1);
+    }
+}
+
+
+//Print a location along with its annotation (and possibly the trigger of its report) into the output buffer
+void Formatter::writeRow(Location *p, unsigned long trigger)
+{
+    if (this->includeTrigger) {
+        appendInteger(trigger);
+        outBuffer[outLength++] = DELIMITER;
+    }
+    if (this->includeId) {   //with identifiers
+        if (p->oid < 0) {
+            outBuffer[outLength++] = '-';
+            appendInteger(-(unsigned long)p->oid);
+        }
+        else
+            appendInteger(p->oid);
+        outBuffer[outLength++] = DELIMITER;
+    }
+    appendFixed(p->x);
+    outBuffer[outLength++] = DELIMITER;
+    appendFixed(p->y);
+    outBuffer[outLength++] = DELIMITER;
+    appendInteger(p->t);
+    outBuffer[outLength++] = DELIMITER;
+    appendFixed(p->speed);
+    outBuffer[outLength++] = DELIMITER;
+    appendFixed(p->heading);
+    outBuffer[outLength++] = DELIMITER;
+    const string &s = p->getAnnotationText();
+    appendText(s.data(), s.size());
+    appendText("\r\n", 2);
+}
+
+
+//Header with column names of the output of trajectory segments
+void Formatter::writeSegmentHeader()
+{
+    const char *header = this->includeId ? "id start_t end_t duration length speed start_annotation end_annotation points polyline\r\n" : "start_t end_t duration length speed start_annotation end_annotation points polyline\r\n";
+    if (this->includeTrigger)
+        appendText("trigger ", 8);
+    appendText(header, strlen(header));
+}
+
+
+//Print a trajectory segment along with its statistics; its critical points are printed last as a WKT polyline with timestamps as measures (i.e., "LINESTRING M (lon lat t, ...)")
+void Formatter::writeSegment(Segment *s, unsigned long trigger)
+{
+    if (this->includeTrigger) {
+        appendInteger(trigger);
+        outBuffer[outLength++] = DELIMITER;
+    }
+    if (this->includeId) {
+        if (s->oid < 0) {
+            outBuffer[outLength++] = '-';
+            appendInteger(-(unsigned long)s->oid);
+        }
+        else
+            appendInteger(s->oid);
+        outBuffer[outLength++] = DELIMITER;
+    }
+    appendInteger(s->startT);
+    outBuffer[outLength++] = DELIMITER;
+    appendInteger(s->endT);
+    outBuffer[outLength++] = DELIMITER;
+    appendInteger(s->getDuration());
+    outBuffer[outLength++] = DELIMITER;
+    appendFixed(s->length);
+    outBuffer[outLength++] = DELIMITER;
+    appendFixed(s->getMeanSpeed());
+    outBuffer[outLength++] = DELIMITER;
+    const string &a = Location::getAnnotationText(s->startAnnotation);
+    const char delimiter = DELIMITER;
+    appendText(a.data(), a.size());
+    appendText(&delimiter, 1);
+    const string &b = Location::getAnnotationText(s->endAnnotation);
+    appendText(b.data(), b.size());
+    appendText(&delimiter, 1);
+    appendInteger(s->points.size());
+    outBuffer[outLength++] = DELIMITER;
+    appendText("LINESTRING M (", 14);
+    for (size_t i = 0; i < s->points.size(); i++) {
+        if (i > 0)
+            appendText(", ", 2);
+        appendFixed(s->points[i].x);
+        outBuffer[outLength++] = ' ';
+        appendFixed(s->points[i].y);
+        outBuffer[outLength++] = ' ';
+        appendInteger(s->points[i].t);
+    }
+    appendText(")\r\n", 3);
+}
+
+
+//Append an unsigned integer in decimal digits to the output buffer
+void Formatter::appendInteger(unsigned long v)
+{
+    if (outLength + 32 > OUTPUT_BUFFER_SIZE)
+        flush();
+
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = '0' + (v % 10);
+        v /= 10;
+    } while (v > 0);
+    while (n > 0)
+        outBuffer[outLength++] = digits[--n];
+}
+
+
+//Append a double number with PRECISION decimal digits to the output buffer; identical to printing with setprecision(PRECISION) and fixed
+//Values are scaled and rounded to an integer, unless too large or too close to a rounding tie; these are left to the standard conversion
+void Formatter::appendFixed(double v)
+{
+    static const unsigned long unit = (unsigned long)pow(10.0, PRECISION);
+
+    if (outLength + 400 > OUTPUT_BUFFER_SIZE)
+        flush();
+
+    unsigned long r;
+    if (scaleToPrecision(v, r)) {
+        if (std::signbit(v))
+            outBuffer[outLength++] = '-';
+        appendInteger(r / unit);
+        if (PRECISION > 0) {
+            outBuffer[outLength++] = '.';
+            unsigned long f = r % unit;
+            for (int i = PRECISION - 1; i >= 0; i--) {
+                outBuffer[outLength + i] = '0' + (f % 10);
+                f /= 10;
+            }
+            outLength += PRECISION;
+        }
+    }
+    else
+        outLength += snprintf(outBuffer + outLength, OUTPUT_BUFFER_SIZE - outLength, "%.*f", PRECISION, v);
+}
+
+
+//Append a sequence of characters to the output buffer
+void Formatter::appendText(const char *c, size_t n)
+{
+    if (outLength + n > OUTPUT_BUFFER_SIZE)
+        flush();
+    if (n > OUTPUT_BUFFER_SIZE - outLength) {     //Longer than the space left in the buffer
+        while (n > 0) {
+            size_t m = min(n, OUTPUT_BUFFER_SIZE - outLength);
+            memcpy(outBuffer + outLength, c, m);
+            outLength += m;
+            c += m;
+            n -= m;
+            flush();
+        }
+        return;
+    }
+    memcpy(outBuffer + outLength, c, n);
+    outLength += n;
+}
+
+
+//Write the contents of the output buffer into the output stream, or hand it over to the writer thread
+//CAUTION! With O_DIRECT, a few trailing bytes may remain in the buffer until the next flush
+void Formatter::flush()
+{
+    if (async != NULL) {
+        outBuffer = async->submit(outBuffer, outLength);
+        return;
+    }
+    if ((outLength > 0) && (out != NULL))
+        out->write(outBuffer, outLength);
+    outLength = 0;
+}
+
+
+//Write all rows formatted so far and get the length of the output in bytes (e.g., for a snapshot of the run); -1 if unknown or incomplete
+long Formatter::sync()
+{
+    if (async != NULL)
+        return async->sync(outBuffer, outLength);
+    flush();
+    if (out == NULL)
+        return -1;
+    out->flush();
+    return out->good() ? (long)out->tellp() : -1;
+}
+
+
+//Write the remaining rows and complete the output; false if any rows could not be written
+//CAUTION! With a writer thread, the file is closed and no more rows may be formatted
+bool Formatter::close()
+{
+    if (async != NULL)
+        return async->close(outBuffer, outLength);
+    flush();
+    return (out == NULL) || out->good();
+}
@@ -0,0 +1,41 @@
+#ifndef FORMATTER_H_
+#define FORMATTER_H_
+
+#include "Columnar.h"
+#include "AsyncWriter.h"
+#include "Segment.h"
+
+using namespace std;
+
+
+//Class for formatting annotated locations into space delimited ASCII rows of an output stream
+//Rows are formatted into a buffer without any heap allocation and written into the stream once the buffer gets full (or when flushed)
+class Formatter {
+public:
+	Formatter(bool, bool);
+	~Formatter();
+
+	void setOutput(ostream *);
+	void setOutput(AsyncWriter *);
+	void writeHeader();
+	void writeRow(Location *, unsigned long);
+	void writeSegmentHeader();
+	void writeSegment(Segment *, unsigned long);
+	void flush();
+	long sync();
+	bool close();
+
+private:
+	ostream *out;			//Stream receiving the formatted rows
+	AsyncWriter *async;		//Writer thread receiving buffers of formatted rows; the buffer is then owned by the writer
+	bool includeId;
+	bool includeTrigger;		//Prefix each row with the trigger of its report
+	char *outBuffer;		//Rows are formatted into this buffer before being written into the output stream
+	size_t outLength;		//Bytes currently in the buffer
+
+	void appendInteger(unsigned long);
+	void appendFixed(double);
+	void appendText(const char *, size_t);
+};
+
+#endif /*FORMATTER_H_*/
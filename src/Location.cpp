@@ -7,9 +7,16 @@
 
 #include "Location.h" 
 
+atomic<long> Location::numLive(0);
+bool Location::counting = false;
+
 //Constructor 
 Location::Location()
 {
+    if (counting)
+        numLive.fetch_add(1, memory_order_relaxed);
+    this->seq = 0;
+
     //Initially unknown spatiotemporal features
     this->speed = 0.0f;
     this->heading = 0.0f;
@@ -17,9 +24,31 @@ Location::Location()
     this->time_elapsed = 0;
 }
 
+//Copy constructor; the copy is accounted as another live location
+Location::Location(const Location &p) : seq(p.seq), oid(p.oid), x(p.x), y(p.y), t(p.t), speed(p.speed), heading(p.heading), time_elapsed(p.time_elapsed), distance(p.distance), annotation(p.annotation)
+{
+    if (counting)
+        numLive.fetch_add(1, memory_order_relaxed);
+}
+
 //Destructor
 Location::~Location()
 {
+    if (counting)
+        numLive.fetch_sub(1, memory_order_relaxed);
+}
+
+//Start counting live locations, e.g., for metrics
+//CAUTION! Must be called before any Location is created and any thread is started; otherwise, the count is not accurate
+void Location::startCounting()
+{
+    counting = true;
+}
+
+//Number of Location objects currently allocated (including any temporaries never released); zero unless counting has started
+long Location::countLive()
+{
+    return numLive.load(memory_order_relaxed);
 }
 
 //Check if this location has been already reported in the output
@@ -79,6 +108,39 @@ vector<string> Location::decodeAnnotation()
     return anno;
 }
 
+
+//Precompute the text for every combination of annotation bits 0-9 (critical points and NOISE), as it is printed in the output
+static vector<string> buildAnnotationTable()
+{
+    vector<string> table(1 << 10);
+    Location p;
+    for (unsigned long bits = 0; bits < table.size(); bits++) {
+        p.annotation = bitset<11>(bits);
+        vector<string> anno = p.decodeAnnotation();
+        for (std::size_t i = 0 ; i < anno.size() ; ++i) {
+            if (i > 0)
+                table[bits] += SEPARATOR;
+            table[bits] += anno[i];
+        }
+    }
+    return table;
+}
+
+
+//Text with the reported mobility features of this location, separated by SEPARATOR (e.g., "GAP_START;CHANGE_IN_HEADING"); no allocation involved
+const string& Location::getAnnotationText()
+{
+    return getAnnotationText(this->annotation.to_ulong());
+}
+
+
+//Text for the given annotation bits, as printed in the output
+const string& Location::getAnnotationText(unsigned long bits)
+{
+    static const vector<string> table = buildAnnotationTable();
+    return table[bits & ((1 << 10) - 1)];
+}
+
 //Check if this location is annotated as a STOP_START
 bool Location::isAnnoStopStart()
 {
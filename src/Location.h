@@ -3,6 +3,7 @@
 
 #include "Config.h" 
 
+#include <atomic>
 #include <bitset>
 #include <vector>
 
@@ -13,8 +14,13 @@ using namespace std;
 class Location {
 public:
 	Location();
+	Location(const Location &);
 	~Location();
 
+	static void startCounting();
+	static long countLive();
+
+	unsigned long seq;	//Arrival order of this location in the input stream (sequence number of its tuple)
 	long oid;   		//A globally unique identifier for the moving object (usually, the MMSI of vessels). REQUIRED
 	double x;   		//Longitude coordinate in decimal degrees (georeference: WGS84) of this point location. REQUIRED
 	double y;   		//Latitude coordinate in decimal degrees (georeference: WGS84) of this point location. REQUIRED
@@ -42,6 +48,8 @@ public:
 
 	bool isAnnotated();
 	vector<string> decodeAnnotation();
+	const string& getAnnotationText();
+	static const string& getAnnotationText(unsigned long);
 
 	bool isReported();
 	void setReported();
@@ -75,7 +83,8 @@ public:
 	void setAnnoNoise();
 
 private:
-
+	static atomic<long> numLive;	//Location objects currently allocated (updated from any thread), e.g., to account for memory held by states and sinks
+	static bool counting;		//Whether live locations are counted at all; only for metrics, so that other runs do not pay for a shared counter
 };
 
 #endif /*LOCATION_H_*/
@@ -0,0 +1,409 @@
+//Title: Metrics.cpp
+//Description: Throughput and latency metrics per batch, along with latency histograms per processing stage, written periodically as JSON lines or Prometheus text.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "Metrics.h"
+#include "State.h"
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
+
+
+//Constructor of an empty histogram
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+
+//Bucket of the given value: exact below 2^HISTOGRAM_SUB_BITS, otherwise one of the linear sub-buckets of its power of two
+unsigned int LatencyHistogram::bucketOf(unsigned long v)
+{
+    if (v < (1UL << HISTOGRAM_SUB_BITS))
+        return v;
+    unsigned int shift = (63 - __builtin_clzl(v)) - HISTOGRAM_SUB_BITS;
+    return ((shift + 1) << HISTOGRAM_SUB_BITS) + ((v >> shift) - (1UL << HISTOGRAM_SUB_BITS));
+}
+
+
+//Highest value falling into the given bucket
+unsigned long LatencyHistogram::highestOf(unsigned int b)
+{
+    if (b < (1U << HISTOGRAM_SUB_BITS))
+        return b;
+    unsigned int shift = (b >> HISTOGRAM_SUB_BITS) - 1;
+    unsigned long sub = b & ((1U << HISTOGRAM_SUB_BITS) - 1);
+    return (((1UL << HISTOGRAM_SUB_BITS) + sub) << shift) + (1UL << shift) - 1;
+}
+
+
+//Record a value
+void LatencyHistogram::record(unsigned long v)
+{
+    counts[bucketOf(v)]++;
+    numValues++;
+    total += v;
+    lo = std::min(lo, v);
+    hi = std::max(hi, v);
+}
+
+
+//Discard all recorded values
+void LatencyHistogram::reset()
+{
+    memset(counts, 0, sizeof(counts));
+    numValues = 0;
+    total = 0;
+    lo = ULONG_MAX;
+    hi = 0;
+}
+
+
+//Number of recorded values
+unsigned long LatencyHistogram::count()
+{
+    return numValues;
+}
+
+
+//Sum of recorded values
+unsigned long LatencyHistogram::sum()
+{
+    return total;
+}
+
+
+//Minimum recorded value; zero if none
+unsigned long LatencyHistogram::min()
+{
+    return (numValues > 0) ? lo : 0;
+}
+
+
+//Maximum recorded value; zero if none
+unsigned long LatencyHistogram::max()
+{
+    return hi;
+}
+
+
+//Mean of recorded values; zero if none
+double LatencyHistogram::mean()
+{
+    return (numValues > 0) ? (1.0 * total / numValues) : 0.0;
+}
+
+
+//Value at the given percentile (e.g., 99.9), i.e., the highest value of the bucket reaching that rank; zero if none
+unsigned long LatencyHistogram::percentile(double q)
+{
+    if (numValues == 0)
+        return 0;
+    unsigned long rank = std::max(1UL, (unsigned long)ceil(q / 100.0 * numValues));
+    unsigned long k = 0;
+    for (unsigned int b = 0; b < HISTOGRAM_SIZE; b++) {
+        k += counts[b];
+        if (k >= rank)
+            return std::min(highestOf(b), hi);
+    }
+    return hi;
+}
+
+
+//Number of recorded values not exceeding the given one (at the precision of the buckets)
+unsigned long LatencyHistogram::countUpTo(unsigned long v)
+{
+    unsigned long k = 0;
+    for (unsigned int b = 0; (b < HISTOGRAM_SIZE) && (highestOf(b) <= v); b++)
+        k += counts[b];
+    return k;
+}
+
+
+
+//Constructor; histograms are written every period seconds of event time (and once processing is complete)
+Metrics::Metrics(const char *fileName, MetricsFormat format, unsigned int period)
+{
+    this->fileName = fileName;
+    this->format = format;
+    this->period = period;
+    this->nextReport = 0;
+    this->numBatches = 0;
+    this->numTuples = 0;
+    this->numWritten = 0;
+    memset(numPerAnnotation, 0, sizeof(numPerAnnotation));
+    memset(&last, 0, sizeof(last));
+    memset(&peak, 0, sizeof(peak));
+
+    fout.open(fileName, ios::out | ios::trunc);
+    failed = !fout.good();
+    if (format == PROMETHEUS_METRICS)
+        fout.close();     //Rewritten as a whole every period
+}
+
+
+//Destructor
+Metrics::~Metrics()
+{
+    if (fout.is_open())
+        fout.close();
+}
+
+
+//Check whether the metrics file can be written
+bool Metrics::good()
+{
+    return !failed;
+}
+
+
+//Record the measurements of a batch, along with the locations written and annotated by the sink so far, and the stopped objects pinning long histories
+void Metrics::record(BatchMetrics &b, vector< pair<long, unsigned int> > &pinned, Sink *sink)
+{
+    account(b.memory, sink);
+    warnPinned(b.t, pinned);
+    numBatches++;
+    numTuples += b.numTuples;
+    readLatency.record(b.readTime);
+    procLatency.record(b.procTime);
+    flushLatency.record(b.flushTime);
+    batchLatency.record(b.readTime + b.procTime + b.flushTime);
+    last = b;
+
+    if (format == JSON_METRICS)
+        writeBatch(b, sink);
+
+    if (nextReport == 0)
+        nextReport = b.t + period;
+    else if (b.t >= nextReport) {
+        if (format == JSON_METRICS) {
+            writeHistograms(b.t);
+            fout << "}" << endl;
+        }
+        else
+            writePrometheus(sink);
+        nextReport = b.t + period;
+    }
+}
+
+
+//Write the latest histograms and totals once processing is complete, along with the memory still held (e.g., locations never released) and the peak memory per owner
+void Metrics::close(Sink *sink)
+{
+    MemoryUsage m;
+    memset(&m, 0, sizeof(m));
+    account(m, sink);
+    last.memory.liveLocations = m.liveLocations;
+    last.memory.rss = m.rss;
+    last.memory.peakRss = m.peakRss;
+    if (format == PROMETHEUS_METRICS) {
+        writePrometheus(sink);
+        return;
+    }
+    writeHistograms(last.t);
+    fout << ",\"final\":true,\"batches\":" << numBatches << ",\"tuples\":" << numTuples << ",\"emitted\":" << sink->countWrittenLocations()
+         << ",\"writer_stalls\":" << sink->countWriterStalls() << ",\"annotations\":{";
+    for (unsigned int k = 0; k < 10; k++)
+        fout << ((k > 0) ? "," : "") << "\"" << Location::getAnnotationText(1UL << k) << "\":" << sink->countAnnotations(k);
+    fout << "},\"memory\":{\"live_locations\":" << m.liveLocations << ",\"centroids\":" << m.numCentroids << ",\"centroids_bytes\":" << m.centroidBytes
+         << ",\"rss_kb\":" << m.rss << ",\"peak_rss_kb\":" << m.peakRss << "},\"peak_memory\":";
+    writeMemory(peak);
+    fout << "}" << endl;
+}
+
+
+//Complete the memory held per owner with the locations pending in the sink, the centroids never released and the resident set size of the process
+//Locations pending in the sink but not retained by any state are those allocated and not accounted for by states or centroids
+void Metrics::account(MemoryUsage &m, Sink *sink)
+{
+    unsigned long numPending = sink->countPendingLocations();
+    m.liveLocations = Location::countLive();
+    m.numCentroids = State::countCentroids();
+    m.centroidBytes = m.numCentroids * sizeof(Location);
+    long numOther = m.liveLocations - (long)(m.stateLocations + m.numCentroids);
+    m.sinkLocations = std::min(numPending, (unsigned long)std::max(numOther, 0L));
+    m.sinkBytes = numPending * (MAP_NODE_BYTES + sizeof(pair< const ReportKey, Location* >)) + m.sinkLocations * sizeof(Location);
+
+    struct rusage usage;
+    m.peakRss = (getrusage(RUSAGE_SELF, &usage) == 0) ? usage.ru_maxrss : 0;
+    m.rss = 0;
+    unsigned long numPages, numResident;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (f != NULL) {
+        if (fscanf(f, "%lu %lu", &numPages, &numResident) == 2)
+            m.rss = numResident * (sysconf(_SC_PAGESIZE) / 1024);
+        fclose(f);
+    }
+    m.peakRss = std::max(m.peakRss, m.rss);     //Sampled at different times
+
+    //Peak per owner over all batches
+    peak.liveLocations = std::max(peak.liveLocations, m.liveLocations);
+    peak.stateLocations = std::max(peak.stateLocations, m.stateLocations);
+    peak.stateBytes = std::max(peak.stateBytes, m.stateBytes);
+    peak.sinkLocations = std::max(peak.sinkLocations, m.sinkLocations);
+    peak.sinkBytes = std::max(peak.sinkBytes, m.sinkBytes);
+    peak.numCentroids = std::max(peak.numCentroids, m.numCentroids);
+    peak.centroidBytes = std::max(peak.centroidBytes, m.centroidBytes);
+    peak.batchBytes = std::max(peak.batchBytes, m.batchBytes);
+    peak.maxHistory = std::max(peak.maxHistory, m.maxHistory);
+    for (unsigned int k = 0; k < HISTORY_BUCKETS; k++)
+        peak.histories[k] = std::max(peak.histories[k], m.histories[k]);
+    peak.numPinned = std::max(peak.numPinned, m.numPinned);
+    peak.pinnedLocations = std::max(peak.pinnedLocations, m.pinnedLocations);
+    peak.rss = std::max(peak.rss, m.rss);
+    peak.peakRss = std::max(peak.peakRss, m.peakRss);
+}
+
+
+//Warn about stopped objects pinning unusually long histories: once they start doing so, and again whenever their histories double
+void Metrics::warnPinned(unsigned int t, vector< pair<long, unsigned int> > &pinned)
+{
+    map< long, unsigned int > current;
+    for (vector< pair<long, unsigned int> >::iterator it = pinned.begin(); it != pinned.end(); it++) {
+        map< long, unsigned int >::iterator iterWarned = warned.find(it->first);
+        unsigned int n = (iterWarned != warned.end()) ? iterWarned->second : 0;
+        if (it->second >= 2 * n) {
+            cerr << "Warning: stopped vessel " << it->first << " retains " << it->second << " locations in its state (about "
+                 << it->second * (sizeof(Location) + LIST_NODE_BYTES + sizeof(Location*)) / 1024 << " KB) at event time " << t << endl;
+            n = it->second;
+        }
+        current[it->first] = n;
+    }
+    warned.swap(current);
+}
+
+
+//Write a JSON line with the measurements of a batch, as well as the locations written and annotated since the previous batch
+void Metrics::writeBatch(BatchMetrics &b, Sink *sink)
+{
+    unsigned long written = sink->countWrittenLocations();
+    fout << "{\"batch\":" << numBatches << ",\"t\":" << b.t << ",\"tuples\":" << b.numTuples
+         << ",\"tuples_per_sec\":" << (unsigned long)(b.numTuples / (1.0e-6 * std::max(b.procTime, 1UL)))
+         << ",\"read_us\":" << b.readTime << ",\"process_us\":" << b.procTime << ",\"flush_us\":" << b.flushTime
+         << ",\"states\":" << b.numStates << ",\"locations\":" << b.numLocations << ",\"pending\":" << sink->countPendingLocations()
+         << ",\"emitted\":" << (written - numWritten) << ",\"annotations\":{";
+    for (unsigned int k = 0; k < 10; k++) {
+        unsigned long n = sink->countAnnotations(k);
+        fout << ((k > 0) ? "," : "") << "\"" << Location::getAnnotationText(1UL << k) << "\":" << (n - numPerAnnotation[k]);
+        numPerAnnotation[k] = n;
+    }
+    fout << "},\"memory\":";
+    writeMemory(b.memory);
+    fout << "}\n";
+    numWritten = written;
+}
+
+
+//Write the memory held per owner as a JSON object, along with the count of states per length of history
+void Metrics::writeMemory(MemoryUsage &m)
+{
+    fout << "{\"live_locations\":" << m.liveLocations << ",\"rss_kb\":" << m.rss << ",\"peak_rss_kb\":" << m.peakRss
+         << ",\"state_locations\":" << m.stateLocations << ",\"states_bytes\":" << m.stateBytes
+         << ",\"sink_locations\":" << m.sinkLocations << ",\"sink_bytes\":" << m.sinkBytes
+         << ",\"centroids\":" << m.numCentroids << ",\"centroids_bytes\":" << m.centroidBytes << ",\"batch_bytes\":" << m.batchBytes
+         << ",\"max_history\":" << m.maxHistory << ",\"pinned\":" << m.numPinned << ",\"pinned_locations\":" << m.pinnedLocations << ",\"histories\":{";
+    for (unsigned int k = 0; k < HISTORY_BUCKETS; k++) {
+        fout << ((k > 0) ? "," : "") << "\"";
+        if (k < 2)
+            fout << k;
+        else if (k < HISTORY_BUCKETS - 1)
+            fout << (1UL << (k - 1)) << "-" << (1UL << k) - 1;
+        else
+            fout << (1UL << (k - 1)) << "+";
+        fout << "\":" << m.histories[k];
+    }
+    fout << "}}";
+}
+
+
+//Write the latency histograms of all stages since the previous period into an unterminated JSON object, and start over
+void Metrics::writeHistograms(unsigned int t)
+{
+    fout << "{\"t\":" << t << ",\"histograms\":{";
+    writeHistogram("read_us", readLatency);
+    fout << ",";
+    writeHistogram("process_us", procLatency);
+    fout << ",";
+    writeHistogram("flush_us", flushLatency);
+    fout << ",";
+    writeHistogram("batch_us", batchLatency);
+    fout << "}";
+    readLatency.reset();
+    procLatency.reset();
+    flushLatency.reset();
+    batchLatency.reset();
+}
+
+
+//Write the summary of a histogram as a JSON member
+void Metrics::writeHistogram(const char *name, LatencyHistogram &h)
+{
+    fout << "\"" << name << "\":{\"count\":" << h.count() << ",\"min\":" << h.min() << ",\"mean\":" << (unsigned long)h.mean()
+         << ",\"p50\":" << h.percentile(50) << ",\"p90\":" << h.percentile(90) << ",\"p99\":" << h.percentile(99)
+         << ",\"p999\":" << h.percentile(99.9) << ",\"max\":" << h.max() << "}";
+}
+
+
+//Rewrite the metrics file in Prometheus text format with the totals and histograms since the start, as well as the latest batch
+//The file is written into a temporary one that replaces it once complete, so that a collector never reads it half-written
+void Metrics::writePrometheus(Sink *sink)
+{
+    string tmpName = fileName + ".tmp";
+    ofstream out(tmpName.c_str(), ios::out | ios::trunc);
+
+    out << "# HELP ais_batches_total Batches processed.\n# TYPE ais_batches_total counter\nais_batches_total " << numBatches << "\n";
+    out << "# HELP ais_tuples_total Tuples consumed from the input.\n# TYPE ais_tuples_total counter\nais_tuples_total " << numTuples << "\n";
+    out << "# HELP ais_locations_written_total Locations written into the output.\n# TYPE ais_locations_written_total counter\nais_locations_written_total " << sink->countWrittenLocations() << "\n";
+    out << "# HELP ais_writer_stalls_total Times formatting of rows waited for the output to be written.\n# TYPE ais_writer_stalls_total counter\nais_writer_stalls_total " << sink->countWriterStalls() << "\n";
+    out << "# HELP ais_annotations_total Reported locations per annotation.\n# TYPE ais_annotations_total counter\n";
+    for (unsigned int k = 0; k < 10; k++)
+        out << "ais_annotations_total{annotation=\"" << Location::getAnnotationText(1UL << k) << "\"} " << sink->countAnnotations(k) << "\n";
+    out << "# HELP ais_event_time_seconds Upper bound (UNIX epoch) of the latest batch.\n# TYPE ais_event_time_seconds gauge\nais_event_time_seconds " << last.t << "\n";
+    out << "# HELP ais_states Vessel states monitored.\n# TYPE ais_states gauge\nais_states " << last.numStates << "\n";
+    out << "# HELP ais_retained_locations Locations retained in all vessel states.\n# TYPE ais_retained_locations gauge\nais_retained_locations " << last.numLocations << "\n";
+    out << "# HELP ais_pending_locations Reported locations not yet written into the output.\n# TYPE ais_pending_locations gauge\nais_pending_locations " << sink->countPendingLocations() << "\n";
+    out << "# HELP ais_live_locations Location objects allocated.\n# TYPE ais_live_locations gauge\nais_live_locations " << last.memory.liveLocations << "\n";
+    out << "# HELP ais_memory_bytes Memory held per owner of locations, excluding allocator overhead.\n# TYPE ais_memory_bytes gauge\n";
+    out << "ais_memory_bytes{owner=\"states\"} " << last.memory.stateBytes << "\n";
+    out << "ais_memory_bytes{owner=\"sink\"} " << last.memory.sinkBytes << "\n";
+    out << "ais_memory_bytes{owner=\"centroids\"} " << last.memory.centroidBytes << "\n";
+    out << "ais_memory_bytes{owner=\"batch\"} " << last.memory.batchBytes << "\n";
+    out << "# HELP ais_resident_memory_bytes Resident set size.\n# TYPE ais_resident_memory_bytes gauge\nais_resident_memory_bytes " << last.memory.rss * 1024 << "\n";
+    out << "# HELP ais_peak_resident_memory_bytes Peak resident set size.\n# TYPE ais_peak_resident_memory_bytes gauge\nais_peak_resident_memory_bytes " << last.memory.peakRss * 1024 << "\n";
+    out << "# HELP ais_pinned_states Stopped vessels pinning unusually long histories.\n# TYPE ais_pinned_states gauge\nais_pinned_states " << last.memory.numPinned << "\n";
+    out << "# HELP ais_state_history_length Locations retained per vessel state.\n# TYPE ais_state_history_length histogram\n";
+    unsigned long numStates = 0;
+    for (unsigned int k = 0; k < HISTORY_BUCKETS - 1; k++) {
+        numStates += last.memory.histories[k];
+        out << "ais_state_history_length_bucket{le=\"" << ((k == 0) ? 0 : (1UL << k) - 1) << "\"} " << numStates << "\n";
+    }
+    numStates += last.memory.histories[HISTORY_BUCKETS - 1];
+    out << "ais_state_history_length_bucket{le=\"+Inf\"} " << numStates << "\n";
+    out << "ais_state_history_length_sum " << last.memory.stateLocations << "\n";
+    out << "ais_state_history_length_count " << numStates << "\n";
+    out << "# HELP ais_batch_throughput_tuples_per_second Tuples annotated per second in the latest batch.\n# TYPE ais_batch_throughput_tuples_per_second gauge\nais_batch_throughput_tuples_per_second "
+        << (unsigned long)(last.numTuples / (1.0e-6 * std::max(last.procTime, 1UL))) << "\n";
+    out << "# HELP ais_batch_duration_seconds Time per batch spent in each stage.\n# TYPE ais_batch_duration_seconds histogram\n";
+    writePrometheusHistogram(out, "read", readLatency);
+    writePrometheusHistogram(out, "process", procLatency);
+    writePrometheusHistogram(out, "flush", flushLatency);
+    writePrometheusHistogram(out, "batch", batchLatency);
+
+    out.close();
+    if (!out.good() || (rename(tmpName.c_str(), fileName.c_str()) != 0))
+        failed = true;
+}
+
+
+//Write the cumulative buckets (upper bounds from 100 microseconds to 10 seconds), sum and count of a histogram for the given stage
+void Metrics::writePrometheusHistogram(ostream &out, const char *stage, LatencyHistogram &h)
+{
+    static const unsigned long bounds[] = { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000 };
+    for (unsigned int i = 0; i < sizeof(bounds) / sizeof(bounds[0]); i++)
+        out << "ais_batch_duration_seconds_bucket{stage=\"" << stage << "\",le=\"" << bounds[i] / 1.0e6 << "\"} " << h.countUpTo(bounds[i]) << "\n";
+    out << "ais_batch_duration_seconds_bucket{stage=\"" << stage << "\",le=\"+Inf\"} " << h.count() << "\n";
+    out << "ais_batch_duration_seconds_sum{stage=\"" << stage << "\"} " << h.sum() / 1.0e6 << "\n";
+    out << "ais_batch_duration_seconds_count{stage=\"" << stage << "\"} " << h.count() << "\n";
+}
@@ -0,0 +1,133 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include "Sink.h"
+#include <fstream>
+#include <string>
+#include <map>
+
+using namespace std;
+
+#define HISTOGRAM_SUB_BITS 5		//Each power of two is split into 2^5 linear sub-buckets, so recorded values are within ~3% of the actual ones
+#define HISTOGRAM_SIZE ((64 - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+#define HISTORY_BUCKETS 12		//States are counted per length of their histories: 0, 1, 2-3, 4-7, ..., 1024 or more locations
+#define MAP_NODE_BYTES 32		//Color and links of a node in a red-black tree (e.g., std::map), besides its value
+#define LIST_NODE_BYTES 16		//Links of a node in a doubly linked list (e.g., std::list), besides its value
+
+
+//Histogram of latencies (in microseconds) with buckets of bounded relative error over the entire range of values (as in HdrHistogram)
+//Recording a value takes a bit scan and an increment, without any allocation
+class LatencyHistogram {
+public:
+	LatencyHistogram();
+
+	void record(unsigned long);
+	void reset();
+	unsigned long count();
+	unsigned long sum();
+	unsigned long min();
+	unsigned long max();
+	double mean();
+	unsigned long percentile(double);
+	unsigned long countUpTo(unsigned long);
+
+private:
+	unsigned long counts[HISTOGRAM_SIZE];	//Count of values per bucket
+	unsigned long numValues;
+	unsigned long total;
+	unsigned long lo;
+	unsigned long hi;
+
+	static unsigned int bucketOf(unsigned long);
+	static unsigned long highestOf(unsigned int);
+};
+
+
+//Format of the metrics file
+enum MetricsFormat {
+	JSON_METRICS,		//A JSON object per line: one per batch, and one with the latency histograms per period
+	PROMETHEUS_METRICS	//Prometheus text exposition format, rewritten at the end of each period (e.g., for the textfile collector of node_exporter)
+};
+
+
+//Memory held by each owner of locations after a batch, in bytes of their objects and containers (excluding any allocator overhead)
+//CAUTION! Reported locations pending in the sink are accounted to states as long as any state retains them
+struct MemoryUsage {
+	long liveLocations;		//Location objects allocated by any owner
+	unsigned long stateLocations;	//Locations retained in the histories of all states
+	unsigned long stateBytes;	//States along with their histories of locations
+	unsigned long sinkLocations;	//Reported locations pending in the sink that no state retains any more
+	unsigned long sinkBytes;	//These locations along with the entries of all locations pending in the sink
+	unsigned long numCentroids;	//Centroids calculated by states so far and never released
+	unsigned long centroidBytes;
+	unsigned long batchBytes;	//Tuples of the batch in flight, as read before processing
+	unsigned long maxHistory;	//Longest history of locations in any state
+	unsigned long histories[HISTORY_BUCKETS];	//Count of states per length of history
+	unsigned int numPinned;		//Stopped objects pinning unusually long histories
+	unsigned long pinnedLocations;	//Locations in the histories of these objects
+	unsigned long rss;		//Resident set size (in KB)
+	unsigned long peakRss;		//Peak resident set size (in KB) so far
+
+	//Bucket of the given length of history
+	static unsigned int historyBucket(unsigned long n) {
+		return (n == 0) ? 0 : std::min(64 - __builtin_clzl(n), HISTORY_BUCKETS - 1);
+	}
+};
+
+
+//Measurements of a batch, as taken by the processing loop
+struct BatchMetrics {
+	unsigned int t;			//Upper bound (in event time) of the batch
+	unsigned long numTuples;	//Tuples consumed in the batch
+	unsigned long readTime;		//Time (in microseconds) spent reading and parsing the batch
+	unsigned long procTime;		//Time (in microseconds) spent annotating the batch
+	unsigned long flushTime;	//Time (in microseconds) spent writing the results that became final
+	unsigned int numStates;		//Vessel states after the batch
+	unsigned long numLocations;	//Locations retained in all vessel states after the batch
+	MemoryUsage memory;		//Memory per owner after the batch
+};
+
+
+//Class for recording throughput and latency per batch and writing them periodically into a metrics file, so that degradation can be traced back to its stage and its cause
+class Metrics {
+public:
+	Metrics(const char *, MetricsFormat, unsigned int);
+	~Metrics();
+
+	bool good();
+	void record(BatchMetrics &, vector< pair<long, unsigned int> > &, Sink *);
+	void close(Sink *);
+
+private:
+	string fileName;
+	MetricsFormat format;
+	unsigned int period;		//Period (in seconds of event time) of writing the histograms
+	unsigned int nextReport;	//Event time of the next histograms; zero before the first batch
+	ofstream fout;			//Metrics file (only for JSON lines)
+	bool failed;
+
+	unsigned long numBatches;
+	unsigned long numTuples;
+	unsigned long numWritten;		//Locations written as of the previous batch
+	unsigned long numPerAnnotation[10];	//Annotations counted as of the previous batch
+	BatchMetrics last;			//Latest batch recorded
+	MemoryUsage peak;			//Maximum memory per owner over all batches
+	map< long, unsigned int > warned;	//Length of history at the latest warning per stopped object still pinning it
+
+	//Latencies per stage of a batch: since the previous period for JSON lines, since the start for Prometheus
+	LatencyHistogram readLatency;
+	LatencyHistogram procLatency;
+	LatencyHistogram flushLatency;
+	LatencyHistogram batchLatency;
+
+	void account(MemoryUsage &, Sink *);
+	void warnPinned(unsigned int, vector< pair<long, unsigned int> > &);
+	void writeBatch(BatchMetrics &, Sink *);
+	void writeMemory(MemoryUsage &);
+	void writeHistograms(unsigned int);
+	void writeHistogram(const char *, LatencyHistogram &);
+	void writePrometheus(Sink *);
+	void writePrometheusHistogram(ostream &, const char *, LatencyHistogram &);
+};
+
+#endif /*METRICS_H_*/
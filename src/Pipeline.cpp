@@ -0,0 +1,158 @@
+//Title: Pipeline.cpp 
+//Description: Pipelined annotation of the stream; parsing of the input, mobility checks and output of the results run concurrently in separate threads.
+//             Results are written progressively: a location is emitted once no location with an earlier timestamp can be reported any more.
+//             This happens when it precedes both the oldest location retained in any state and the next input batch, so the output is identical to a single-threaded run.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "Pipeline.h"
+
+
+//Constructor
+Pipeline::Pipeline(Scan *scan, unsigned int t0, map< string, Config* > *configs, VesselRegistry *info, Sink *sink, bool annotatedOnly, bool groupByVessel, bool proactive, unsigned int horizon)
+{
+    this->scanStream = scan;
+    this->t0 = t0;
+    this->sinkStream = sink;
+    this->annotatedOnly = annotatedOnly;
+    this->buffer = new Sink(sink->collectsSegments());
+    this->engine = new Engine(configs, info, buffer);
+    this->engine->groupByVessel = groupByVessel;
+    this->engine->proactive = proactive;
+    this->engine->horizon = horizon;
+
+    inQueue = new SpscQueue< InputBatch* >(16);
+    outQueue = new SpscQueue< OutputBatch* >(16);
+
+    reader.busy = reader.idle = 0;
+    annotator.busy = annotator.idle = 0;
+    writer.busy = writer.idle = 0;
+}
+
+
+//Destructor; releases states of all objects
+Pipeline::~Pipeline()
+{
+    delete engine;
+    delete buffer;
+    delete inQueue;
+    delete outQueue;
+}
+
+
+//Run the reader and the annotator in their own threads and the writer in the calling one, until the stream is exhausted
+//CAUTION! Locations reported once the stream is exhausted remain in the output sink, until emitted along with any other pending results
+void Pipeline::run()
+{
+    std::thread readerThread(&Pipeline::read, this);
+    std::thread annotatorThread(&Pipeline::annotate, this);
+
+    this->write();
+
+    readerThread.join();
+    annotatorThread.join();
+}
+
+
+//READER stage: consume the input in batches of SLIDE seconds
+void Pipeline::read()
+{
+    unsigned long t_start = get_time_micro();
+    unsigned int t = t0;
+
+    while (scanStream->exhausted == false) {
+        //Proceed to accept next batch of tuples up to this timestamp value 
+        t = t + SLIDE;
+        InputBatch *batch = new InputBatch();
+        batch->tuples = scanStream->consumeInput(t);
+        if (batch->tuples.empty()) {
+            delete batch;
+            continue;
+        }
+        batch->tMin = UINT_MAX;
+        for (vector<Location *>::iterator it = batch->tuples.begin(); it != batch->tuples.end(); it++)
+            batch->tMin = min(batch->tMin, (*it)->t);
+
+        unsigned long t_wait = get_time_micro();
+        inQueue->put(batch);     //Waits if the annotator lags behind (backpressure)
+        reader.idle += get_time_micro() - t_wait;
+    }
+
+    inQueue->put(NULL);
+    reader.busy = get_time_micro() - t_start - reader.idle;
+}
+
+
+//ANNOTATOR stage: update states with each batch and hand over the reported locations to the writer
+//The next batch is fetched before handing over, as its earliest timestamp bounds the locations that may still be reported
+void Pipeline::annotate()
+{
+    unsigned long t_start = get_time_micro();
+
+    unsigned long t_wait = get_time_micro();
+    InputBatch *batch = inQueue->take();
+    annotator.idle += get_time_micro() - t_wait;
+
+    while (batch != NULL) {
+        engine->process(batch->tuples);
+
+        t_wait = get_time_micro();
+        InputBatch *next = inQueue->take();
+        annotator.idle += get_time_micro() - t_wait;
+
+        OutputBatch *out = new OutputBatch();
+        out->reports = new Sink(buffer->collectsSegments());
+        out->reports->absorb(buffer);
+        out->watermark = engine->oldestTimestamp();
+        if (next != NULL)
+            out->watermark = min(out->watermark, next->tMin);
+
+        t_wait = get_time_micro();
+        outQueue->put(out);      //Waits if the writer lags behind (backpressure)
+        annotator.idle += get_time_micro() - t_wait;
+
+        delete batch;
+        batch = next;
+    }
+
+    //Once the stream is exhausted, expunge any remaining positions from the last state of each sequence
+    engine->close();
+    OutputBatch *out = new OutputBatch();
+    out->reports = new Sink(buffer->collectsSegments());
+    out->reports->absorb(buffer);
+    out->watermark = 0;          //Nothing more to emit; results are pending in the output sink
+    outQueue->put(out);
+    outQueue->put(NULL);
+
+    annotator.busy = get_time_micro() - t_start - annotator.idle;
+}
+
+
+//WRITER stage: collect reported locations into the output sink and emit those preceding the watermark
+void Pipeline::write()
+{
+    unsigned long t_start = get_time_micro();
+
+    while (true) {
+        unsigned long t_wait = get_time_micro();
+        OutputBatch *out = outQueue->take();
+        writer.idle += get_time_micro() - t_wait;
+        if (out == NULL)
+            break;
+
+        sinkStream->absorb(out->reports);
+        sinkStream->flush(out->watermark, annotatedOnly);
+        delete out->reports;
+        delete out;
+    }
+
+    writer.busy = get_time_micro() - t_start - writer.idle;
+}
+
+
+//Number of objects monitored
+unsigned int Pipeline::countStates()
+{
+    return engine->countStates();
+}
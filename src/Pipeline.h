@@ -0,0 +1,59 @@
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include "Engine.h"
+#include "SpscQueue.h"
+
+using namespace std;
+
+
+//Time spent (in microseconds) by a pipeline stage doing actual work or waiting for its neighbours
+//A stage that is seldom idle bounds the throughput of the entire pipeline
+struct StageTimes {
+	unsigned long busy;		//Reading, annotating or writing
+	unsigned long idle;		//Waiting for input (empty queue) or for room in the output queue (backpressure)
+};
+
+
+//Class for annotating a stream with three pipelined threads: a reader parsing input batches, an annotator updating vessel states, and a writer emitting final results
+//Stages are connected by bounded lock-free queues of batches, so that parsing and output to file overlap with the mobility checks
+class Pipeline {
+public:
+	Pipeline(Scan *, unsigned int, map< string, Config* > *, VesselRegistry *, Sink *, bool, bool, bool = false, unsigned int = 0);
+	~Pipeline();
+
+	void run();
+
+	unsigned int countStates();
+	StageTimes reader;
+	StageTimes annotator;
+	StageTimes writer;
+
+private:
+	//Batch of tuples parsed by the reader
+	struct InputBatch {
+		vector<Location *> tuples;
+		unsigned int tMin;		//Earliest timestamp in this batch
+	};
+
+	//Locations reported while annotating a batch; none of the locations reported afterwards may precede the watermark
+	struct OutputBatch {
+		Sink *reports;
+		unsigned int watermark;
+	};
+
+	Scan *scanStream;
+	unsigned int t0;			//Timestamp in the first row of the input
+	Engine *engine;
+	Sink *buffer;				//Collects locations reported by the annotator until handed over to the writer
+	Sink *sinkStream;			//Output sink; written by the writer only
+	bool annotatedOnly;
+	SpscQueue< InputBatch* > *inQueue;	//From reader to annotator; an empty pointer signifies the end of the stream
+	SpscQueue< OutputBatch* > *outQueue;	//From annotator to writer; an empty pointer signifies the end of the stream
+
+	void read();
+	void annotate();
+	void write();
+};
+
+#endif /*PIPELINE_H_*/
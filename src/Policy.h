@@ -0,0 +1,116 @@
+#ifndef POLICY_H_
+#define POLICY_H_
+
+#include "Config.h"
+
+using namespace std;
+
+
+//Mobility rule policies: each one supplies the thresholds used by the rules in State, either from the Config bound at runtime or as compile-time constants.
+//Profiles with constexpr thresholds let the compiler fold every comparison against a constant and eliminate branches that can never be taken for that vessel type.
+//CAUTION! A compiled-in profile is only applied to a vessel type if ALL its settings in params.json coincide with its constants; otherwise the runtime policy is used.
+
+
+//Runtime policy: thresholds are read from the Config bound to each state (e.g., types only defined in params.json)
+struct RuntimePolicy {
+	static const char* name() { return "Runtime"; }
+	static unsigned int state_size(const Config *c) { return c->state_size; }
+	static unsigned int state_timespan(const Config *c) { return c->state_timespan; }
+	static unsigned int gap_period(const Config *c) { return c->gap_period; }
+	static double low_speed(const Config *c) { return c->low_speed; }
+	static double max_speed(const Config *c) { return c->max_speed; }
+	static double no_speed(const Config *c) { return c->no_speed; }
+	static double speed_ratio(const Config *c) { return c->speed_ratio; }
+	static double max_rate_of_change(const Config *c) { return c->max_rate_of_change; }
+	static double max_rate_of_turn(const Config *c) { return c->max_rate_of_turn; }
+	static double distance_threshold(const Config *c) { return c->distance_threshold; }
+	static double angle_threshold(const Config *c) { return c->angle_threshold; }
+};
+
+
+//DEFAULT profile; same settings as in the constructor of Config
+struct DefaultPolicy {
+	static const char* name() { return "Default"; }
+	static constexpr unsigned int state_size(const Config *) { return 5; }
+	static constexpr unsigned int state_timespan(const Config *) { return 1000; }
+	static constexpr unsigned int gap_period(const Config *) { return 600; }
+	static constexpr double low_speed(const Config *) { return 2.0; }
+	static constexpr double max_speed(const Config *) { return 30.0; }
+	static constexpr double no_speed(const Config *) { return 0.5; }
+	static constexpr double speed_ratio(const Config *) { return 0.25; }
+	static constexpr double max_rate_of_change(const Config *) { return 100.0; }
+	static constexpr double max_rate_of_turn(const Config *) { return 3.0; }
+	static constexpr double distance_threshold(const Config *) { return 50.0; }
+	static constexpr double angle_threshold(const Config *) { return 5.0; }
+};
+
+
+//FISHING vessels: sharper turns are allowed
+struct FishingPolicy : public DefaultPolicy {
+	static const char* name() { return "Fishing"; }
+	static constexpr double max_rate_of_turn(const Config *) { return 5.0; }
+	static constexpr double angle_threshold(const Config *) { return 3.0; }
+};
+
+
+//PASSENGER vessels
+struct PassengerPolicy : public DefaultPolicy {
+	static const char* name() { return "Passenger"; }
+	static constexpr double max_rate_of_change(const Config *) { return 500.0; }
+	static constexpr double angle_threshold(const Config *) { return 10.0; }
+};
+
+
+//TANKER vessels
+struct TankerPolicy : public DefaultPolicy {
+	static const char* name() { return "Tanker"; }
+	static constexpr double max_rate_of_change(const Config *) { return 500.0; }
+};
+
+
+//CARGO vessels
+struct CargoPolicy : public DefaultPolicy {
+	static const char* name() { return "Cargo"; }
+	static constexpr double low_speed(const Config *) { return 1.0; }
+	static constexpr double no_speed(const Config *) { return 0.4; }
+	static constexpr double distance_threshold(const Config *) { return 150.0; }
+};
+
+
+//TUG vessels
+struct TugPolicy : public DefaultPolicy {
+	static const char* name() { return "Tug"; }
+	static constexpr double max_rate_of_change(const Config *) { return 300.0; }
+};
+
+
+//Check whether ALL settings of the given configuration coincide with the constants of a compiled-in profile
+template <class P>
+inline bool matchesPolicy(const Config *c)
+{
+	return (c->state_size == P::state_size(c)) && (c->state_timespan == P::state_timespan(c)) && (c->gap_period == P::gap_period(c))
+	    && (c->low_speed == P::low_speed(c)) && (c->max_speed == P::max_speed(c)) && (c->no_speed == P::no_speed(c))
+	    && (c->speed_ratio == P::speed_ratio(c)) && (c->max_rate_of_change == P::max_rate_of_change(c)) && (c->max_rate_of_turn == P::max_rate_of_turn(c))
+	    && (c->distance_threshold == P::distance_threshold(c)) && (c->angle_threshold == P::angle_threshold(c));
+}
+
+
+//Copy the constants of a compiled-in profile into the given configuration
+template <class P>
+inline void applyPolicy(Config *c)
+{
+	c->vessel_type = P::name();
+	c->state_size = P::state_size(c);
+	c->state_timespan = P::state_timespan(c);
+	c->gap_period = P::gap_period(c);
+	c->low_speed = P::low_speed(c);
+	c->max_speed = P::max_speed(c);
+	c->no_speed = P::no_speed(c);
+	c->speed_ratio = P::speed_ratio(c);
+	c->max_rate_of_change = P::max_rate_of_change(c);
+	c->max_rate_of_turn = P::max_rate_of_turn(c);
+	c->distance_threshold = P::distance_threshold(c);
+	c->angle_threshold = P::angle_threshold(c);
+}
+
+#endif /*POLICY_H_*/
@@ -0,0 +1,244 @@
+//Title: Replay.cpp 
+//Description: Parallel annotation of an archived input file split into time ranges, with boundary state stitching.
+//             Each range is annotated by a worker thread, after warming up vessel states over an overlap preceding the range. At each boundary, the state of every vessel
+//             obtained at the end of the previous range is compared against the warmed-up state. Vessels with diverging states (e.g., with a GAP or STOP crossing the boundary)
+//             are re-run over the range starting from the state of the previous range, and their results replace those of the worker. Hence, the output equals a serial run.
+//ASSUMPTION: The input file is sorted by ascending timestamp values (UNIX epochs in seconds).
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "Replay.h"
+
+
+//Constructor; splits the input file into time ranges of the given span (in seconds), each one preceded by a warm-up overlap (in seconds)
+Replay::Replay(char *fileName, long attrId, long objectId, map< string, Config* > *configs, VesselRegistry *info, Sink *sink, unsigned int span, unsigned int warmup, unsigned int numThreads, bool groupByVessel)
+{
+    this->fileName = fileName;
+    this->attrId = attrId;
+    this->objectId = objectId;
+    this->vesselTypeConfigs = configs;
+    this->vesselInfo = info;
+    this->sinkStream = sink;
+    this->numThreads = (numThreads > 0) ? numThreads : 1;
+    this->groupByVessel = groupByVessel;
+    this->numRerun = 0;
+    this->part = 0;
+    this->numParts = 1;
+    this->nextRange.store(0);
+
+    //Time ranges span from the first to the last timestamp in the input
+    unsigned int tFirst = Scan::firstTimestamp(fileName);
+    unsigned int tLast = Scan::lastTimestamp(fileName);
+
+    for (unsigned int k = 0; (tFirst > 0) && (tFirst + (unsigned long)k * span <= tLast); k++) {
+        Range r;
+        r.start = tFirst + k * span;
+        r.end = (tFirst + (unsigned long)(k + 1) * span > tLast) ? 0xFFFFFFFF : tFirst + (k + 1) * span;
+        r.warmStart = (r.start - tFirst > warmup) ? r.start - warmup : tFirst;
+        r.offset = Scan::locate(fileName, r.warmStart);
+        r.seqBase = (unsigned long)(k + 1) << 40;
+        r.sink = new Sink();
+        r.engine = new Engine(configs, info, r.sink);
+        r.engine->groupByVessel = groupByVessel;
+        r.count = 0;
+        ranges.push_back(r);
+    }
+}
+
+
+//Only annotate vessels assigned to the given partition (out of numParts); rows of other vessels are skipped at parse time
+void Replay::setPartition(unsigned int part, unsigned int numParts)
+{
+    this->part = part;
+    this->numParts = numParts;
+}
+
+
+//Destructor
+Replay::~Replay()
+{
+    for (unsigned int k = 0; k < ranges.size(); k++) {
+        delete ranges[k].engine;
+        delete ranges[k].sink;
+    }
+    for (unsigned int i = 0; i < rerunSinks.size(); i++)
+        delete rerunSinks[i];
+}
+
+
+//Annotate all time ranges in parallel, stitch their states at the boundaries in chronological order, and collect all results into the output sink
+void Replay::run()
+{
+    vector<std::thread> workers;
+    for (unsigned int i = 0; i < numThreads; i++)
+        workers.push_back(std::thread(&Replay::work, this));
+    for (unsigned int i = 0; i < numThreads; i++)
+        workers[i].join();
+
+    for (unsigned int k = 1; k < ranges.size(); k++)
+        this->stitch(k);
+
+    //Once the stream is exhausted, report the remaining locations of all vessels
+    if (!ranges.empty())
+        ranges.back().engine->close();
+
+    for (unsigned int k = 0; k < ranges.size(); k++)
+        sinkStream->absorb(ranges[k].sink);
+    for (unsigned int i = 0; i < rerunSinks.size(); i++)
+        sinkStream->absorb(rerunSinks[i]);
+}
+
+
+//Worker thread: annotate time ranges not yet claimed by other workers
+void Replay::work()
+{
+    unsigned int k;
+    while ((k = nextRange++) < ranges.size())
+        this->annotate(k);
+}
+
+
+//Annotate the tuples of a time range after warming up the states over its preceding overlap
+void Replay::annotate(unsigned int k)
+{
+    Range &r = ranges[k];
+
+    Scan scan(fileName, attrId);
+    scan.id = objectId;
+    scan.setPartition(part, numParts);
+    scan.seek(r.offset, r.seqBase);
+
+    //Reports triggered during warm-up are not collected
+    bool owned = (r.warmStart == r.start);
+    r.sink->setTriggerFloor(owned ? 0 : 0xFFFFFFFFFFFFFFFFUL);
+
+    vector<Location *> inTuples;
+    unsigned long lastSeq = r.seqBase;
+    unsigned int t = r.warmStart - 1;
+    while (scan.exhausted == false) {
+        //Next batch of tuples, which must not cross the start or the end of the range
+        unsigned int bound = t + SLIDE;
+        if (!owned && (bound >= r.start))
+            bound = r.start - 1;
+        else if (owned && (bound >= r.end))
+            bound = r.end - 1;
+
+        inTuples = scan.consumeInput(bound);
+        if (!inTuples.empty())
+            lastSeq = inTuples.back()->seq;
+        if (owned) {
+            r.count += inTuples.size();
+            for (vector<Location *>::iterator it = inTuples.begin(); it != inTuples.end(); it++)
+                r.seen.insert((*it)->oid);
+        }
+        r.engine->process(inTuples);
+        t = bound;
+
+        if (!owned && (t == r.start - 1)) {
+            //Warm-up complete; keep the resulting states for comparison with those at the end of the previous range
+            r.engine->fingerprints(r.crossing);
+            r.sink->setTriggerFloor(lastSeq + 1);
+            owned = true;
+        }
+        else if (owned && (t == r.end - 1))
+            break;
+    }
+}
+
+
+//Stitch the states at the start of a range with those at the end of its previous range
+//CAUTION! States at the end of the previous range must have been stitched already
+void Replay::stitch(unsigned int k)
+{
+    Range &prev = ranges[k-1];
+    Range &cur = ranges[k];
+
+    Sink *rerunSink = new Sink();
+    Engine rerunEngine(vesselTypeConfigs, vesselInfo, rerunSink);
+    set<long> rerun;
+
+    vector<long> objects;
+    prev.engine->listObjects(objects);
+    for (vector<long>::iterator it = objects.begin(); it != objects.end(); it++) {
+        State *s = prev.engine->release(*it);
+
+        //Warm-up yielded the same state as the one at the end of the previous range, so the results of this range are valid
+        map< long, string >::iterator c = cur.crossing.find(*it);
+        if ((c != cur.crossing.end()) && (c->second == s->fingerprint())) {
+            delete s;
+            continue;
+        }
+
+        if (cur.seen.count(*it) > 0) {  //Diverging state: this vessel must be re-run over the range
+            rerunEngine.adopt(*it, s);
+            rerun.insert(*it);
+        }
+        else                            //No tuples of this vessel in the range, so its state carries over unchanged
+            cur.engine->adopt(*it, s);
+    }
+
+    if (rerun.empty()) {
+        delete rerunSink;
+        return;
+    }
+
+    //Replace the results of diverging vessels with those obtained from re-running them (using the same sequence numbers for tuples)
+    cur.sink->discardObjects(rerun);
+    numRerun += rerun.size();
+
+    Scan scan(fileName, attrId);
+    scan.id = objectId;
+    scan.setPartition(part, numParts);
+    scan.seek(cur.offset, cur.seqBase);
+
+    vector<Location *> inTuples;
+    unsigned int t = cur.warmStart - 1;
+    while ((scan.exhausted == false) && (t < cur.end - 1)) {
+        t = (t + SLIDE < cur.end - 1) ? t + SLIDE : cur.end - 1;
+        inTuples = scan.consumeInput(t);
+        for (vector<Location *>::iterator it = inTuples.begin(); it != inTuples.end(); it++) {
+            if (((*it)->t >= cur.start) && (rerun.count((*it)->oid) > 0))
+                rerunEngine.process(*it);
+            else
+                delete *it;
+        }
+    }
+
+    //Re-run states become the ones at the end of this range
+    for (set<long>::iterator it = rerun.begin(); it != rerun.end(); it++)
+        cur.engine->adopt(*it, rerunEngine.release(*it));
+
+    rerunSinks.push_back(rerunSink);
+}
+
+
+//Number of tuples consumed from the input
+unsigned int Replay::countTuples()
+{
+    unsigned int n = 0;
+    for (unsigned int k = 0; k < ranges.size(); k++)
+        n += ranges[k].count;
+    return n;
+}
+
+
+//Number of objects monitored
+unsigned int Replay::countStates()
+{
+    return ranges.empty() ? 0 : ranges.back().engine->countStates();
+}
+
+
+//Number of time ranges
+unsigned int Replay::countRanges()
+{
+    return ranges.size();
+}
+
+
+//Number of vessels re-run at range boundaries because of diverging states
+unsigned int Replay::countRerunObjects()
+{
+    return numRerun;
+}
@@ -0,0 +1,62 @@
+#ifndef REPLAY_H_
+#define REPLAY_H_
+
+#include "Engine.h"
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+
+//Class for annotating an archived input file split into time ranges (e.g., per day) that are processed in parallel
+//Each range first warms up the states of vessels over a preceding overlap; states are then stitched at the boundaries, so that the results are equivalent to a serial run
+class Replay {
+public:
+	Replay(char *, long, long, map< string, Config* > *, VesselRegistry *, Sink *, unsigned int, unsigned int, unsigned int, bool);
+	~Replay();
+
+	void run();
+	void setPartition(unsigned int, unsigned int);
+
+	unsigned int countTuples();
+	unsigned int countStates();
+	unsigned int countRanges();
+	unsigned int countRerunObjects();
+
+private:
+	//A time range of the input file
+	struct Range {
+		unsigned int warmStart;		//Timestamp where warm-up begins
+		unsigned int start;		//First timestamp owned by this range
+		unsigned int end;		//Timestamps owned by this range are strictly below this one
+		streamoff offset;		//Byte offset of the first tuple at warm-up
+		unsigned long seqBase;		//Sequence numbers of tuples in this range follow this value
+		Engine *engine;			//States of vessels in this range
+		Sink *sink;			//Locations reported by tuples owned by this range
+		map< long, string > crossing;	//Fingerprints of states when warm-up completes
+		unordered_set<long> seen;	//Vessels with tuples owned by this range
+		unsigned int count;		//Number of tuples owned by this range
+	};
+
+	char *fileName;
+	long attrId;
+	long objectId;				//Identifier of the SINGLE object being monitored (if no identifiers in input)
+	map< string, Config* > *vesselTypeConfigs;
+	VesselRegistry *vesselInfo;
+	Sink *sinkStream;			//Output sink; all buffers are merged into this one
+	unsigned int numThreads;
+	bool groupByVessel;
+	unsigned int part;			//Partition of vessels handled (out of numParts)
+	unsigned int numParts;
+
+	vector<Range> ranges;
+	vector<Sink *> rerunSinks;		//Locations reported when re-running vessels with diverging states
+	unsigned int numRerun;
+	std::atomic<unsigned int> nextRange;
+
+	void work();
+	void annotate(unsigned int);
+	void stitch(unsigned int);
+};
+
+#endif /*REPLAY_H_*/
@@ -9,12 +9,17 @@
 
 
 #include "Scan.h" 
+#include "Checkpoint.h"
 
 //Constructor for reading tuples according to the specified stream source
 Scan::Scan(char *fileName, long attrId)
 {
     fin.open(fileName, ios::in);
     this->recCount = 0;
+    this->seqCount = 0;
+    this->skipCount = 0;
+    this->part = 0;
+    this->numParts = 1;
     this->exhausted = false;
     this->curTime = 0;
     this->inLine = "";
@@ -33,6 +38,7 @@ Scan::Scan(char *fileName, long attrId)
 Scan::~Scan()
 {
     fin.close();  
+    delete inTuple;     //Prefetched tuple never consumed (e.g., beyond the end of a time range)
 }
 
 
@@ -42,6 +48,171 @@ void Scan::setTimeAttribute(unsigned int attrTime)
 }
 
 
+//Resume reading from the given byte offset in the input file (which must be the start of a line)
+//Tuples read from now on get sequence numbers following the given base value
+void Scan::seek(streamoff offset, unsigned long seqBase)
+{
+    fin.clear();
+    fin.seekg(offset);
+    this->seqCount = seqBase;
+    this->exhausted = false;
+    this->inTuple = NULL;
+}
+
+
+//Only handle objects assigned to the given partition (out of numParts) by their identifiers; rows of other objects are skipped at parse time
+//CAUTION! Skipped rows still count in sequence numbers, so these remain consistent among all partitions of the same input
+void Scan::setPartition(unsigned int part, unsigned int numParts)
+{
+    this->part = part;
+    this->numParts = (numParts > 0) ? numParts : 1;
+}
+
+
+//Identify the first line starting at or after the given byte offset and get its timestamp (the last attribute); false if no such line exists
+bool Scan::lineAfter(ifstream &in, streamoff pos, streamoff &lineStart, unsigned int &t)
+{
+    string line;
+    in.clear();
+    if (pos > 0) {
+        in.seekg(pos - 1);
+        getline(in, line);     //Skip the remainder of the line containing the previous byte
+    }
+    else
+        in.seekg(0);
+
+    lineStart = in.tellg();
+    if ((lineStart < 0) || !getline(in, line))
+        return false;
+
+    size_t end = line.find_last_not_of(" \t\r");
+    if (end == string::npos)
+        return false;
+    size_t begin = line.find_last_of(" \t", end);
+    t = strtoul(line.c_str() + ((begin == string::npos) ? 0 : begin + 1), NULL, 10);
+    return true;
+}
+
+
+//Byte offset of the first line in the input file with a timestamp not below the given one (or the file size, if no such line exists)
+//ASSUMPTION: The input file is sorted by ascending timestamp values, so a binary search over byte offsets is applicable
+streamoff Scan::locate(char *fileName, unsigned int t)
+{
+    ifstream in(fileName, ios::in | ios::binary);
+    in.seekg(0, ios::end);
+    streamoff lo = 0, hi = in.tellg();
+    streamoff lineStart;
+    unsigned int tLine;
+
+    while (lo < hi) {
+        streamoff mid = lo + (hi - lo) / 2;
+        if (!lineAfter(in, mid, lineStart, tLine) || (tLine >= t))
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    if (lineAfter(in, lo, lineStart, tLine))
+        return lineStart;
+    in.clear();
+    in.seekg(0, ios::end);
+    return in.tellg();
+}
+
+
+//Timestamp of the first line in the input file
+unsigned int Scan::firstTimestamp(char *fileName)
+{
+    ifstream in(fileName, ios::in | ios::binary);
+    streamoff lineStart;
+    unsigned int t = 0;
+    lineAfter(in, 0, lineStart, t);
+    return t;
+}
+
+
+//Timestamp of the last line in the input file
+unsigned int Scan::lastTimestamp(char *fileName)
+{
+    ifstream in(fileName, ios::in | ios::binary);
+    in.seekg(0, ios::end);
+    streamoff pos = in.tellg();
+    streamoff lineStart;
+    unsigned int t = 0;
+
+    //Step back from the end of file until the start of the last line is found
+    for (streamoff step = 256; pos > 0; step *= 2) {
+        pos = (pos > step) ? pos - step : 0;
+        unsigned int tLine;
+        streamoff next = pos;
+        bool found = false;
+        while (lineAfter(in, next, lineStart, tLine)) {
+            t = tLine;
+            found = true;
+            next = lineStart + 1;
+        }
+        if (found)
+            break;
+    }
+    return t;
+}
+
+
+//Append the position in the input to a snapshot, including the tuple already prefetched (if any)
+void Scan::save(string &buf)
+{
+    unsigned char flag = this->exhausted ? 1 : 0;
+    long offset = this->exhausted ? 0 : (long)fin.tellg();     //Negative if the end of the input has been reached
+    putValue(buf, flag);
+    putValue(buf, this->curTime);
+    putValue(buf, this->seqCount);
+    putValue(buf, this->skipCount);
+    putValue(buf, offset);
+
+    flag = (inTuple != NULL) ? 1 : 0;
+    putValue(buf, flag);
+    if (inTuple != NULL) {
+        putValue(buf, inTuple->oid);
+        putValue(buf, inTuple->x);
+        putValue(buf, inTuple->y);
+        putValue(buf, inTuple->t);
+        putValue(buf, inTuple->seq);
+    }
+}
+
+
+//Resume from the position in a snapshot: the same input is consumed from that position on, unless it had been exhausted;
+//then the (new) input is consumed from its start, with sequence numbers following those of the snapshot
+bool Scan::load(const char *&p, const char *end)
+{
+    unsigned char exhaustedBefore, prefetched;
+    long offset;
+    if (!getValue(p, end, exhaustedBefore) || !getValue(p, end, this->curTime) || !getValue(p, end, this->seqCount) ||
+        !getValue(p, end, this->skipCount) || !getValue(p, end, offset) || !getValue(p, end, prefetched))
+        return false;
+
+    if (prefetched) {
+        Location *q = new Location();
+        if (!getValue(p, end, q->oid) || !getValue(p, end, q->x) || !getValue(p, end, q->y) || !getValue(p, end, q->t) || !getValue(p, end, q->seq)) {
+            delete q;
+            return false;
+        }
+        inTuple = q;
+    }
+
+    this->exhausted = false;
+    if (!exhaustedBefore) {
+        fin.clear();
+        if (offset >= 0)
+            fin.seekg(offset);
+        else
+            fin.seekg(0, ios::end);
+        return fin.good();
+    }
+    return true;
+}
+
+
 //Depending on the mode, it calls a specific function to read input tuples
 vector<Location*> Scan::consumeInput(unsigned int t)
 {
@@ -52,20 +223,49 @@ vector<Location*> Scan::consumeInput(unsigned int t)
 }
 
 
+//Timestamp of the next tuple to be consumed (already prefetched), or the maximum possible value if the input is exhausted
+//ASSUMPTION: The input file is sorted by ascending timestamp values, so no subsequent tuple may have an earlier timestamp
+unsigned int Scan::nextTimestamp()
+{
+    return ((inTuple != NULL) ? inTuple->t : UINT_MAX);
+}
+
+
 //Decode tuple attributes from incoming string value into object location attributes
 Location* Scan::decodeTuple(fstream &fin)
 {
     Location *inTuple = new Location(); 
 
+    //The SINGLE object belongs to another partition; skip the entire input
+    if ((this->id > 0) && (this->numParts > 1) && (partitionObject(this->id, this->numParts) != this->part))
+        fin.ignore(numeric_limits<streamsize>::max());
+
     //Important read test in order to avoid empty lines   
     if ((this->id > 0) && (fin >> inTuple->x >> inTuple->y >> inTuple->t )) { // SINGLE object    
         inTuple->oid = this->id;    //Associate attributes with the SINGLE object being monitored  
+        inTuple->seq = ++this->seqCount;
         return inTuple;
     }
-    else if (fin >> inTuple->oid >> inTuple->x >> inTuple->y >> inTuple->t ) {  // MULTIPLE objects in input stream    
-        return inTuple;
+    else if (fin >> inTuple->oid) {  // MULTIPLE objects in input stream
+        //Skip rows of objects in other partitions without decoding their remaining attributes
+        while ((this->numParts > 1) && (partitionObject(inTuple->oid, this->numParts) != this->part)) {
+            fin.ignore(numeric_limits<streamsize>::max(), '\n');
+            ++this->seqCount;
+            this->skipCount++;
+            if (!(fin >> inTuple->oid)) {
+                delete inTuple;
+                return NULL;
+            }
+        }
+        if (fin >> inTuple->x >> inTuple->y >> inTuple->t) {
+            inTuple->seq = ++this->seqCount;
+            return inTuple;
+        }
+        delete inTuple;
+        return NULL;
     }
     else {  //Empty line
+        delete inTuple;
         return NULL;
     }
 }
@@ -77,6 +277,7 @@ void Scan::read(unsigned int t)
     if (inTuple != NULL) {
         if (inTuple->t <= t) { //Only in case it fits within the upper window bound
             batchTuples.push_back(inTuple);
+            inTuple = NULL;
             recCount++;
         }
         else                //No need to consume more tuples, as the upper window bound has not reached the next timestamp value in input
@@ -12,8 +12,18 @@ public:
 	~Scan();
 	void setTimeAttribute(unsigned int);
 	vector<Location *> consumeInput(unsigned int);
+	unsigned int nextTimestamp();
+	void seek(streamoff, unsigned long);
+	void setPartition(unsigned int, unsigned int);
+	static streamoff locate(char *, unsigned int);
+	static unsigned int firstTimestamp(char *);
+	static unsigned int lastTimestamp(char *);
+	void save(string &);
+	bool load(const char *&, const char *);
 	bool exhausted;		     //Set TRUE at EOF
 	unsigned int recCount;       //Count incoming tuples
+	unsigned long seqCount;      //Sequence number assigned to the latest decoded tuple
+	unsigned int skipCount;      //Count tuples of objects in other partitions
 	unsigned int curTime;
 	long id;                     //Identifier of the SINGLE object being monitored
 	bool mode;
@@ -23,9 +33,12 @@ private:
 	string inLine;
 	Location *inTuple;
 	unsigned int attrTime;
+	unsigned int part;           //Partition of objects handled by this scan
+	unsigned int numParts;       //Number of partitions; 1 if all objects are handled
 	void read(unsigned int);
 	vector<Location *> batchTuples;
 	Location* decodeTuple(fstream &);
+	static bool lineAfter(ifstream &, streamoff, streamoff &, unsigned int &);
 };
 
 #endif /*SCAN_H_*/
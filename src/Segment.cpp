@@ -0,0 +1,64 @@
+//Title: Segment.cpp
+//Description: Trajectory segment of a vessel between stops and gaps, along with its critical points and statistics (duration, length, mean speed).
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "Segment.h"
+
+
+//Constructor; the segment starts at the given location
+Segment::Segment(Location *p)
+{
+    oid = p->oid;
+    startT = endT = p->t;
+    startAnnotation = endAnnotation = p->annotation.to_ulong();
+    length = 0.0;
+    numLocations = 1;
+    SegmentPoint c = { p->x, p->y, p->t };
+    points.push_back(c);
+    last = p;
+}
+
+
+//Destructor
+Segment::~Segment() {}
+
+
+//Extend the segment with the next location of the vessel; its distance from the previous one is added to the length
+void Segment::add(Location *p)
+{
+    length += p->distance;
+    numLocations++;
+    endT = p->t;
+    endAnnotation = p->annotation.to_ulong();
+    last = p;
+    if (p->isAnnotated()) {
+        SegmentPoint c = { p->x, p->y, p->t };
+        points.push_back(c);
+    }
+}
+
+
+//Take the final annotation of the last location
+//CAUTION! The last location may still be annotated once reported (e.g., a CHANGE_IN_HEADING right before a gap), so this must be called just before the segment is written, while that location is still available
+void Segment::complete()
+{
+    if (last != NULL)
+        endAnnotation = last->annotation.to_ulong();
+    last = NULL;
+}
+
+
+//Time elapsed (in seconds) from the first to the last location
+unsigned int Segment::getDuration()
+{
+    return endT - startT;
+}
+
+
+//Average speed (in knots) along the segment
+double Segment::getMeanSpeed()
+{
+    return (getDuration() > 0) ? (3600.0 * length) / (1852.0 * getDuration()) : 0.0;
+}
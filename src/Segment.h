@@ -0,0 +1,42 @@
+#ifndef SEGMENT_H_
+#define SEGMENT_H_
+
+#include "Location.h"
+#include <vector>
+
+using namespace std;
+
+
+//Critical point along a segment
+struct SegmentPoint {
+	double x;
+	double y;
+	unsigned t;
+};
+
+
+//Class for a trajectory segment of a vessel between the end of a stop or gap (GAP_END, STOP_END) and the start of the next one (GAP_START, STOP_START)
+//Statistics are accumulated incrementally, as each location of the vessel becomes final, so the segment is complete as soon as its last location is reported
+class Segment {
+public:
+	Segment(Location *);
+	~Segment();
+
+	void add(Location *);
+	void complete();
+
+	unsigned int getDuration();
+	double getMeanSpeed();
+
+	long oid;			//Vessel identifier
+	unsigned startT;		//Timestamp of the first location
+	unsigned endT;			//Timestamp of the last location
+	unsigned long startAnnotation;	//Annotation bits of the first location
+	unsigned long endAnnotation;	//Annotation bits of the last location
+	double length;			//Travelled distance (in meters) along all (noise-free) locations
+	unsigned int numLocations;	//Number of (noise-free) locations
+	vector<SegmentPoint> points;	//Critical points (annotated locations), including the first and the last one
+	Location *last;			//Last location, until the segment is completed
+};
+
+#endif /*SEGMENT_H_*/
@@ -0,0 +1,168 @@
+//Title: ShardedEngine.cpp 
+//Description: Multi-threaded annotation of the stream, partitioned by vessel; each worker thread maintains the states of the vessels assigned to its shard.
+//             Since states are independent per vessel and reported locations are ordered by keys that depend only on the input, results are identical to a single-threaded run.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "ShardedEngine.h"
+
+
+//Constructor; with a single shard, tuples are processed by the calling thread straight into the output sink
+ShardedEngine::ShardedEngine(unsigned int n, map< string, Config* > *configs, VesselRegistry *info, Sink *sink, bool groupByVessel, bool proactive, unsigned int horizon)
+{
+    this->numShards = (n > 0) ? n : 1;
+    this->sinkStream = sink;
+
+    for (unsigned int i = 0; i < numShards; i++) {
+        Sink *shardSink = (numShards > 1) ? new Sink(sink->collectsSegments()) : sink;
+        Engine *engine = new Engine(configs, info, shardSink);
+        engine->groupByVessel = groupByVessel;
+        engine->proactive = proactive;
+        engine->horizon = horizon;
+        engines.push_back(engine);
+        shardSinks.push_back(shardSink);
+    }
+
+    //Start worker threads, each one consuming its own queue of batches
+    if (numShards > 1) {
+        for (unsigned int i = 0; i < numShards; i++) {
+            queues.push_back(new SpscQueue< pair< vector<Location *>*, unsigned int > >(64));
+            readySinks.push_back(new Sink(sink->collectsSegments()));
+            watermarks.push_back(0);
+        }
+        for (unsigned int i = 0; i < numShards; i++)
+            workers.push_back(std::thread(&ShardedEngine::work, this, i));
+    }
+}
+
+
+//Destructor
+ShardedEngine::~ShardedEngine()
+{
+    for (unsigned int i = 0; i < numShards; i++) {
+        delete engines[i];
+        if (numShards > 1) {
+            delete shardSinks[i];
+            delete readySinks[i];
+            delete queues[i];
+        }
+    }
+}
+
+
+//Worker thread: process batches routed to this shard until the end of the stream
+//After each batch, results before the oldest location retained in this shard (or the next tuple in the input, if earlier) are final, so they are handed over for the output sink
+void ShardedEngine::work(unsigned int shard)
+{
+    pair< vector<Location *>*, unsigned int > batch;
+    while ((batch = queues[shard]->take()).first != NULL) {
+        engines[shard]->process(*batch.first);
+        delete batch.first;
+
+        unsigned int watermark = min(engines[shard]->oldestTimestamp(), batch.second);
+        std::lock_guard<std::mutex> lock(handover);
+        readySinks[shard]->absorb(shardSinks[shard], watermark);
+        watermarks[shard] = watermark;
+    }
+
+    //End of stream: report the remaining locations in the states of this shard
+    engines[shard]->close();
+}
+
+
+//Route the tuples of a batch to the shards of their vessels; tuples of each vessel retain their arrival order
+//Every shard gets the batch (even if empty) along with the timestamp of the next tuple in the input, so its watermark advances
+void ShardedEngine::process(vector<Location *> &inTuples, unsigned int next)
+{
+    if (numShards == 1) {
+        engines[0]->process(inTuples);
+        return;
+    }
+
+    vector< vector<Location *>* > routed(numShards, NULL);
+    for (unsigned int i = 0; i < numShards; i++)
+        routed[i] = new vector<Location *>();
+    for (vector<Location *>::iterator it = inTuples.begin(); it != inTuples.end(); it++)
+        routed[hashObject((*it)->oid, numShards)]->push_back(*it);
+
+    for (unsigned int i = 0; i < numShards; i++)
+        queues[i]->put(make_pair(routed[i], next));   //Waits if this shard lags behind (backpressure)
+}
+
+
+//Once the stream is exhausted, let all workers report their remaining locations and merge their buffers into the output sink
+void ShardedEngine::close()
+{
+    if (numShards == 1) {
+        engines[0]->close();
+        return;
+    }
+
+    for (unsigned int i = 0; i < numShards; i++)
+        queues[i]->put(make_pair((vector<Location *> *)NULL, UINT_MAX));
+    for (unsigned int i = 0; i < numShards; i++)
+        workers[i].join();
+    workers.clear();
+
+    for (unsigned int i = 0; i < numShards; i++) {
+        sinkStream->absorb(readySinks[i]);
+        sinkStream->absorb(shardSinks[i]);
+    }
+}
+
+
+//Timestamp of the oldest location retained in any state, i.e., results before it are final in the output sink
+//With multiple shards, the results handed over by all workers are first moved into the output sink, and the earliest watermark of all shards is returned
+//CAUTION! Only called by the thread feeding the batches, which owns the output sink
+unsigned int ShardedEngine::oldestTimestamp()
+{
+    if (numShards == 1)
+        return engines[0]->oldestTimestamp();
+
+    unsigned int t = UINT_MAX;
+    std::lock_guard<std::mutex> lock(handover);
+    for (unsigned int i = 0; i < numShards; i++) {
+        sinkStream->absorb(readySinks[i]);
+        t = min(t, watermarks[i]);
+    }
+    return t;
+}
+
+
+//Number of objects monitored across all shards
+unsigned int ShardedEngine::countStates()
+{
+    unsigned int k = 0;
+    for (unsigned int i = 0; i < numShards; i++)
+        k += engines[i]->countStates();
+    return k;
+}
+
+
+//Number of locations retained in the states of all shards
+//CAUTION! With multiple shards, only once the stream is exhausted
+unsigned long ShardedEngine::countLocations()
+{
+    unsigned long k = 0;
+    for (unsigned int i = 0; i < numShards; i++)
+        k += engines[i]->countLocations();
+    return k;
+}
+
+
+//Add the memory held by the states of all shards to the given usage
+//CAUTION! Only safe while no worker is running, i.e., with a single shard
+void ShardedEngine::measure(MemoryUsage &m, vector< pair<long, unsigned int> > &pinned)
+{
+    for (unsigned int i = 0; i < numShards; i++)
+        engines[i]->measure(m, pinned);
+}
+
+
+//Engine of the given shard
+//CAUTION! With multiple shards, its states are updated concurrently by a worker thread until the stream is exhausted
+Engine* ShardedEngine::getEngine(unsigned int shard)
+{
+    return engines[shard];
+}
@@ -0,0 +1,42 @@
+#ifndef SHARDEDENGINE_H_
+#define SHARDEDENGINE_H_
+
+#include "Engine.h"
+#include "SpscQueue.h"
+#include <mutex>
+
+using namespace std;
+
+
+//Class for annotating a stream with multiple worker threads, each one owning the states of a partition of the vessels (by hash of their MMSI)
+//Each worker collects its reported locations in its own sink buffer; all buffers are merged into the output sink in a deterministic order
+//After each batch, a worker hands over the results that became final in its shard, so the output sink is flushed progressively up to the earliest watermark of all shards
+class ShardedEngine {
+public:
+	ShardedEngine(unsigned int, map< string, Config* > *, VesselRegistry *, Sink *, bool, bool = false, unsigned int = 0);
+	~ShardedEngine();
+
+	void process(vector<Location *> &, unsigned int = UINT_MAX);
+	void close();
+	unsigned int oldestTimestamp();
+
+	unsigned int countStates();
+	unsigned long countLocations();
+	void measure(MemoryUsage &, vector< pair<long, unsigned int> > &);
+	Engine* getEngine(unsigned int);
+
+private:
+	unsigned int numShards;
+	Sink *sinkStream;				//Output sink; all shard buffers are merged into this one
+	vector<Engine *> engines;			//Engine per shard
+	vector<Sink *> shardSinks;			//Buffer of reported locations per shard
+	vector<Sink *> readySinks;			//Results final in each shard, handed over by its worker for the output sink
+	vector<unsigned int> watermarks;		//Watermark per shard as of its latest batch; no result before it may be reported by that shard any more
+	std::mutex handover;				//Guards the results handed over and the watermarks of all shards
+	vector< SpscQueue< pair< vector<Location *>*, unsigned int > > *> queues;	//Batches routed to each shard along with the next timestamp in the input; an empty batch signifies the end of the stream
+	vector<std::thread> workers;
+
+	void work(unsigned int);
+};
+
+#endif /*SHARDEDENGINE_H_*/
@@ -6,54 +6,118 @@
 //Revision: 20/5/2025
 
 #include "Sink.h" 
+#include "Checkpoint.h"
 
 
 //Constructor 
-Sink::Sink(char * outFileName, bool includeId = true)
+//If includeTrigger is set, each row is prefixed with the ordering key of its report (e.g., in the output of a partition to be merged afterwards)
+//With COLUMNAR_OUTPUT, results are written into a binary columnar file instead (without triggers)
+//Text rows are written into the file by a separate thread, with O_DIRECT if directIO is set
+//If resumeAt is not negative, text rows are appended to the existing file after its first resumeAt bytes (and no header), e.g., continuing the output of a run restored from a snapshot
+Sink::Sink(char * outFileName, bool includeId, bool includeTrigger, OutputFormat format, bool directIO, long resumeAt)
 {
     //Prepare output file
-    fout.open(outFileName);
+    columnar = NULL;
+    synopsis = NULL;
+    split = NULL;
+    formatter = NULL;
+    writer = NULL;
+    filter = NULL;
+    index = NULL;
+    numWritten = 0;
+    segments = (format == SEGMENT_OUTPUT);
+    if (format == COLUMNAR_OUTPUT)
+        columnar = new ColumnarWriter(outFileName, includeId);
+    else if (format == SYNOPSIS_OUTPUT)
+        synopsis = new SynopsisWriter(outFileName, includeId);
+    else {
+        writer = new AsyncWriter(outFileName, directIO, resumeAt);
+        formatter = new Formatter(includeId, includeTrigger);
+        formatter->setOutput(writer);
+    }
 
     //Check if identifiers will be inluced in the output
     this->includeId = includeId;
+    this->includeTrigger = includeTrigger;
     
     //Initialize counters
     numAnno = 0;
     numNoise = 0;
+    memset(numPerAnnotation, 0, sizeof(numPerAnnotation));
+    numReported = 0;
+    curTrigger = 0;
+    minTrigger = 0;
 
     // Create header for the output file
-    vector<string> fields;  //Output fields
-    if (this->includeId) {
-        fields = { "id", "lon", "lat", "t", "speed", "heading", "annotation" };  //MULTIPLE objects in single output file
-    } 
-    else {
-        fields = { "lon", "lat", "t", "speed", "heading", "annotation" };  //SINGLE object
-    }
-    this->setHeader(fields);
+    if ((formatter != NULL) && (resumeAt >= 0))
+        return;
+    if (segments)
+        formatter->writeSegmentHeader();
+    else if (formatter != NULL)
+        formatter->writeHeader();
 }
 
 
-//Destructor
-Sink::~Sink()
+//Constructor for a sink writing the results of MULTIPLE objects into separate files per vessel or per bucket of vessels; the sink takes over the given writer
+Sink::Sink(SplitWriter *split)
 {
-    //Close output file of annotated points
-    fout.close(); 
+    this->includeId = true;
+    this->includeTrigger = false;
+    columnar = NULL;
+    synopsis = NULL;
+    formatter = NULL;
+    writer = NULL;
+    filter = NULL;
+    index = NULL;
+    numWritten = 0;
+    this->split = split;
+    segments = false;
+    numAnno = 0;
+    numNoise = 0;
+    memset(numPerAnnotation, 0, sizeof(numPerAnnotation));
+    numReported = 0;
+    curTrigger = 0;
+    minTrigger = 0;
 }
 
 
-//Header with column names in the output file with the annotated points
-void Sink::setHeader(vector<string> fields)
+//Constructor for a sink that only buffers reported locations (e.g., per shard) without any output file
+//If segments is set, trajectory segments are also collected, e.g., on behalf of a sink with SEGMENT_OUTPUT
+Sink::Sink(bool segments)
 {
-    unsigned int count = 0;
-    for (auto & fld : fields) {
-        fout << fld;
-        count++;
+    this->segments = segments;
+    this->includeId = true;
+    this->includeTrigger = false;
+    columnar = NULL;
+    synopsis = NULL;
+    split = NULL;
+    formatter = NULL;
+    writer = NULL;
+    filter = NULL;
+    index = NULL;
+    numWritten = 0;
+    numAnno = 0;
+    numNoise = 0;
+    memset(numPerAnnotation, 0, sizeof(numPerAnnotation));
+    numReported = 0;
+    curTrigger = 0;
+    minTrigger = 0;
+}
 
-        if (count == fields.size()) 
-            fout << "\r\n";
-        else 
-            fout << DELIMITER ;
-    }   
+
+//Destructor
+Sink::~Sink()
+{
+    //Close output file of annotated points
+    delete formatter;       //Last rows are written and the file is closed
+    delete writer;
+    delete columnar;
+    delete synopsis;
+    delete split;
+    delete index;
+    for (map< ReportKey, Segment* >::iterator it = segResults.begin(); it != segResults.end(); it++)
+        delete it->second;
+    releaseDropped();
 }
 
 
@@ -67,8 +131,159 @@ void Sink::reportPoint(Location *p)
     //Mark this point as reported
     p->setReported();
 
+    //Skip reports triggered by tuples that only serve to warm up states
+    //CAUTION! The update in progress may still refer to this location (e.g., as the previous one of its object), so it is released later on
+    if (curTrigger < minTrigger) {
+        dropped.push_back(p);
+        return;
+    }
+
     //Insert this location to the results
-    annoResults.insert(pair< unsigned, Location* >(p->t, p));
+    ReportKey key = { p->t, curTrigger, numReported++ };
+    annoResults.insert(pair< ReportKey, Location* >(key, p));
+}
+
+
+//Emits a completed trajectory segment to the output QUEUE; the sink takes over the segment
+void Sink::reportSegment(Segment *s)
+{
+    //Skip reports triggered by tuples that only serve to warm up states
+    if (curTrigger < minTrigger) {
+        delete s;
+        return;
+    }
+
+    ReportKey key = { s->endT, curTrigger, numReported++ };
+    segResults.insert(pair< ReportKey, Segment* >(key, s));
+}
+
+
+//Move all locations (and segments) collected by another sink (e.g., a shard buffer) with timestamps before t into this one; their ordering keys are kept intact
+//CAUTION! Keys never collide across sinks, as each tuple (and its trigger) is handled by exactly one sink
+void Sink::absorb(Sink *other, unsigned int t)
+{
+    ReportKey bound = { t, 0, 0 };
+    map< ReportKey, Location* >::iterator lastLoc = (t == UINT_MAX) ? other->annoResults.end() : other->annoResults.lower_bound(bound);
+    annoResults.insert(other->annoResults.begin(), lastLoc);
+    other->annoResults.erase(other->annoResults.begin(), lastLoc);
+    map< ReportKey, Segment* >::iterator lastSeg = (t == UINT_MAX) ? other->segResults.end() : other->segResults.lower_bound(bound);
+    segResults.insert(other->segResults.begin(), lastSeg);
+    other->segResults.erase(other->segResults.begin(), lastSeg);
+}
+
+
+//Specify the first tuple whose reports will be collected in this sink
+void Sink::setTriggerFloor(unsigned long seq)
+{
+    minTrigger = seq;
+}
+
+
+//Specify predicates on the locations to be written into the output; counts of annotated and noisy locations still concern all of them
+void Sink::setFilter(Filter *filter)
+{
+    this->filter = filter;
+}
+
+
+//Build a spatio-temporal index of the written locations; the sink takes ownership of the index
+void Sink::setIndex(IndexWriter *index)
+{
+    this->index = index;
+}
+
+
+//Drop and release all collected locations of the given objects
+void Sink::discardObjects(set<long> &objects)
+{
+    map< ReportKey, Location* >::iterator iterLoc = annoResults.begin();
+    while (iterLoc != annoResults.end()) {
+        if (objects.count(iterLoc->second->oid) > 0) {
+            delete iterLoc->second;
+            annoResults.erase(iterLoc++);
+        }
+        else
+            ++iterLoc;
+    }
+    map< ReportKey, Segment* >::iterator iterSeg = segResults.begin();
+    while (iterSeg != segResults.end()) {
+        if (objects.count(iterSeg->second->oid) > 0) {
+            delete iterSeg->second;
+            segResults.erase(iterSeg++);
+        }
+        else
+            ++iterSeg;
+    }
+}
+
+
+//Append the locations collected but not yet written to a snapshot, along with their ordering keys
+//CAUTION! Segments are not included, so no snapshot may be taken while segments are collected
+void Sink::save(string &buf)
+{
+    unsigned long numPending = annoResults.size();
+    putValue(buf, numReported);
+    putValue(buf, numPending);
+    for (map< ReportKey, Location* >::iterator iterLoc = annoResults.begin(); iterLoc != annoResults.end(); iterLoc++) {
+        putValue(buf, iterLoc->first.t);
+        putValue(buf, iterLoc->first.trigger);
+        putValue(buf, iterLoc->first.order);
+        putLocation(buf, iterLoc->second);
+    }
+}
+
+
+//Collect the pending locations of a snapshot, to be written along with those reported from now on; reports continue the order of the snapshot
+bool Sink::load(const char *&p, const char *end)
+{
+    unsigned long numPending;
+    if (!getValue(p, end, numReported) || !getValue(p, end, numPending))
+        return false;
+
+    for (unsigned long i = 0; i < numPending; i++) {
+        ReportKey key;
+        if (!getValue(p, end, key.t) || !getValue(p, end, key.trigger) || !getValue(p, end, key.order))
+            return false;
+        Location *q = getLocation(p, end);
+        if (q == NULL)
+            return false;
+        annoResults.insert(annoResults.end(), pair< ReportKey, Location* >(key, q));
+    }
+    return true;
+}
+
+
+//Release all collected locations without writing them (e.g., once saved into a snapshot)
+void Sink::clear()
+{
+    for (map< ReportKey, Location* >::iterator iterLoc = annoResults.begin(); iterLoc != annoResults.end(); iterLoc++)
+        delete iterLoc->second;
+    annoResults.clear();
+}
+
+
+//Specify the tuple whose processing triggers any subsequent reports
+void Sink::setTrigger(unsigned long seq)
+{
+    if (!dropped.empty())       //Updates triggered by the previous tuple are complete
+        releaseDropped();
+    curTrigger = seq;
+}
+
+
+//Release the locations reported but not collected so far
+void Sink::releaseDropped()
+{
+    for (vector<Location*>::iterator it = dropped.begin(); it != dropped.end(); it++)
+        delete *it;
+    dropped.clear();
+}
+
+
+//Trigger for reports issued once the stream is exhausted; these follow all tuples, in ascending order of object identifiers
+unsigned long Sink::endOfStream(long oid)
+{
+    return (1UL << 63) | (unsigned long)oid;
 }
 
 
@@ -76,43 +291,122 @@ void Sink::reportPoint(Location *p)
 //If annotatedOnly is set to true, only annotated points will be issued into the output (i.e., neither normal nor noisy points).
 void Sink::emitResults(bool annotatedOnly)
 {
-    multimap< unsigned, Location* >::iterator iterLoc;
+    map< ReportKey, Location* >::iterator iterLoc;
+
+    writeSegments(UINT_MAX);      //Before their last locations are released
+
+    //Iterate over all collected locations, releasing them once written
+    for (iterLoc = annoResults.begin(); iterLoc != annoResults.end(); iterLoc++) {
+        this->writeLocation(iterLoc->second, iterLoc->first.trigger, annotatedOnly);
+        delete iterLoc->second;
+    }
+    annoResults.clear();
+    flushOutput();
+}
+
+
+//Emits the collected trajectory points with timestamps before the given watermark, removes them from the QUEUE and releases them
+//CAUTION! Only safe if no location with an earlier timestamp may be reported afterwards and no state retains any emitted location (e.g., all such locations have expired from the states)
+void Sink::flush(unsigned int t, bool annotatedOnly)
+{
+    writeSegments(t);      //Before their last locations are released
 
-    Location *p;
+    map< ReportKey, Location* >::iterator iterLoc = annoResults.begin();
+    while ((iterLoc != annoResults.end()) && (iterLoc->first.t < t)) {
+        this->writeLocation(iterLoc->second, iterLoc->first.trigger, annotatedOnly);
+        delete iterLoc->second;
+        annoResults.erase(iterLoc++);
+    }
+    flushOutput();
+}
 
-    //Iterate over all collected locations
-    for (iterLoc = annoResults.begin(); iterLoc != annoResults.end(); iterLoc++) { 
-        p = iterLoc->second;  
-  
-        //Check is there is some annotation for this location
-        std::string s = "";
-        if (p->isAnnotated()) {
-            numAnno++;
-            vector<string> anno = p->decodeAnnotation();
-            for (std::size_t i = 0 ; i < anno.size() ; ++i)
-                s += anno[i] + SEPARATOR;
 
-            //Remove last SEPARATOR
-            s = s.substr(0, s.size()-1);
-        }
-        else if (p->isAnnoNoise()) {
-            numNoise++;
-            s = "NOISE";
-        }
+//Print a location along with its annotation (and possibly the trigger of its report) into the output
+void Sink::writeLocation(Location *p, unsigned long trigger, bool annotatedOnly)
+{
+    //Check is there is some annotation for this location
+    if (p->isAnnotated())
+        numAnno++;
+    else if (p->isAnnoNoise())
+        numNoise++;
+    for (unsigned long bits = p->annotation.to_ulong() & ((1 << 10) - 1), k = 0; bits != 0; bits >>= 1, k++)
+        numPerAnnotation[k] += (bits & 1);
+
+    //Check if only annotated locations should be issued to the output
+    if (annotatedOnly && !p->isAnnotated())
+        return;
+
+    //Only segments are written
+    if (segments)
+        return;
+
+    //Skip locations not satisfying the filters before any formatting
+    if ((filter != NULL) && !filter->accept(p))
+        return;
 
-        //Check if only annotated locations should be issued to the output
-        if (annotatedOnly && !p->isAnnotated())
-            continue;
+    if (index != NULL)
+        index->append(p, numWritten);
+    numWritten++;
 
-        //Print the location to the output file
-        if (this->includeId)   //with identifiers
-            fout << p->oid << DELIMITER << setprecision(PRECISION) << fixed << p->x << DELIMITER << setprecision(PRECISION) << fixed << p->y << DELIMITER << p->t << DELIMITER << setprecision(PRECISION) << fixed << p->speed << DELIMITER << setprecision(PRECISION) << fixed << p->heading << DELIMITER << s << "\r\n";                 
-        else             //without identifiers
-            fout << setprecision(PRECISION) << fixed << p->x << DELIMITER << setprecision(PRECISION) << fixed << p->y << DELIMITER << p->t << DELIMITER << setprecision(PRECISION) << fixed << p->speed << DELIMITER << setprecision(PRECISION) << fixed << p->heading << DELIMITER << s << "\r\n";   
+    if (columnar != NULL)       //Binary columnar output
+        columnar->append(p);
+    else if (synopsis != NULL)  //Blocks per vessel in a synopsis store
+        synopsis->append(p);
+    else if (split != NULL)     //Separate files per vessel or bucket
+        split->append(p);
+    else
+        formatter->writeRow(p, trigger);
+}
+
+
+//Print all collected segments ending before the given timestamp into the output and release them
+void Sink::writeSegments(unsigned int t)
+{
+    map< ReportKey, Segment* >::iterator iterSeg = segResults.begin();
+    while ((iterSeg != segResults.end()) && (iterSeg->first.t < t)) {
+        iterSeg->second->complete();
+        if (formatter != NULL)
+            formatter->writeSegment(iterSeg->second, iterSeg->first.trigger);
+        delete iterSeg->second;
+        segResults.erase(iterSeg++);
     }
 }
 
 
+//Write all rows emitted so far into the output
+void Sink::flushOutput()
+{
+    if (formatter != NULL)
+        formatter->flush();
+    else if (split != NULL)
+        split->dispatch();
+}
+
+
+//Write all results emitted so far into the output file and get its length in bytes, so that a run restored from a snapshot may continue it; -1 if the output is not a text file or incomplete
+long Sink::sync()
+{
+    return (formatter == NULL) ? -1 : formatter->sync();
+}
+
+
+//Complete the output files once all results have been emitted; false if any rows could not be written into any of them
+//CAUTION! No more results may be emitted afterwards
+bool Sink::close()
+{
+    bool complete = (formatter == NULL) || formatter->close();
+    if (columnar != NULL)
+        complete = columnar->close() && complete;
+    if (synopsis != NULL)
+        complete = synopsis->close() && complete;
+    if (split != NULL)
+        complete = split->close() && complete;
+    if (index != NULL)
+        complete = index->close() && complete;
+    return complete;
+}
+
+
 //Get number of annotated locations reported so far
 unsigned int Sink::countAnnotatedLocations()
 {
@@ -125,3 +419,31 @@ unsigned int Sink::countNoisyLocations()
 {
     return numNoise;
 }
+
+
+//Get number of locations reported so far with the given annotation bit (see Location.h)
+unsigned long Sink::countAnnotations(unsigned int k)
+{
+    return numPerAnnotation[k];
+}
+
+
+//Get number of locations written into the output so far
+unsigned long Sink::countWrittenLocations()
+{
+    return numWritten;
+}
+
+
+//Get number of reported locations not yet written, since they may precede later reports
+unsigned long Sink::countPendingLocations()
+{
+    return annoResults.size();
+}
+
+
+//Get number of times formatting of rows had to wait for the disk, i.e., the output was written slower than produced
+unsigned long Sink::countWriterStalls()
+{
+    return (writer != NULL) ? writer->countStalls() : 0;
+}
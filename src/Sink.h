@@ -2,31 +2,104 @@
 #define SINK_H_
 
 #include "Scan.h" 
+#include "Columnar.h"
+#include "Formatter.h"
+#include "SplitWriter.h"
+#include "Filter.h"
+#include "SpatialIndex.h"
+#include "Synopsis.h"
 
 using namespace std;
 
 
+//Ordering of reported locations in the output: by timestamp, then by arrival of the tuple whose processing triggered the report, then by order of reporting
+//CAUTION! This order does not depend on the order in which objects are processed within a batch, as long as each object receives its tuples in arrival order
+struct ReportKey {
+	unsigned t;			//Timestamp of the reported location
+	unsigned long trigger;		//Sequence number of the tuple being processed when this location was reported
+	unsigned long order;		//Order of reporting in this sink
+
+	bool operator<(const ReportKey &k) const {
+		if (t != k.t)
+			return (t < k.t);
+		if (trigger != k.trigger)
+			return (trigger < k.trigger);
+		return (order < k.order);
+	}
+};
+
+
+//Format of the output file
+enum OutputFormat {
+	TEXT_OUTPUT,		//Space delimited ASCII rows
+	COLUMNAR_OUTPUT,	//Binary columns in row groups (see Columnar.h)
+	SPLIT_OUTPUT,		//Space delimited ASCII rows in a separate file per vessel or per bucket of vessels (see SplitWriter.h)
+	SEGMENT_OUTPUT,		//Space delimited ASCII rows with a trajectory segment each (see Segment.h), instead of locations
+	SYNOPSIS_OUTPUT		//Binary blocks of locations per vessel appended to a synopsis store (see Synopsis.h)
+};
+
+
 //Class for collecting results into an output file
 class Sink {
 public:
-	Sink(char *, bool);
+	Sink(char *, bool, bool = false, OutputFormat = TEXT_OUTPUT, bool = false, long = -1);
+	Sink(SplitWriter *);
+	Sink(bool = false);
 	~Sink();
 
 	void reportPoint(Location *);
+	void reportSegment(Segment *);
+	bool collectsSegments() { return segments; }
+	void setTrigger(unsigned long);
+	static unsigned long endOfStream(long);
+	void absorb(Sink *, unsigned int = UINT_MAX);
+	void setTriggerFloor(unsigned long);
+	void setFilter(Filter *);
+	void setIndex(IndexWriter *);
+	void discardObjects(set<long> &);
+	void save(string &);
+	bool load(const char *&, const char *);
+	void clear();
 
 	unsigned int countAnnotatedLocations();
 	unsigned int countNoisyLocations();
+	unsigned long countAnnotations(unsigned int);
+	unsigned long countWrittenLocations();
+	unsigned long countPendingLocations();
 	void emitResults(bool);
+	void flush(unsigned int, bool);
+	long sync();
+	bool close();
+	unsigned long countWriterStalls();
 
 private:
-	ofstream fout;
 	unsigned int numAnno;
 	unsigned int numNoise;
+	unsigned long numPerAnnotation[10];	//Count locations per annotation bit (including NOISE), whether written or not
 	bool includeId;
+	bool includeTrigger;		//Prefix each row with the trigger of its report, so that partial outputs can be merged in the same order
+	unsigned long curTrigger;	//Sequence number of the tuple currently being processed
+	unsigned long numReported;	//Count reported locations
+	unsigned long minTrigger;	//Reports triggered by tuples before this one are not collected
+	vector<Location*> dropped;	//Locations reported but not collected, released once the update that reported them is complete
+
+	map< ReportKey, Location* > annoResults;   //Annotated locations ordered by timestamp
+	bool segments;				//Whether trajectory segments are collected (and written instead of locations)
+	map< ReportKey, Segment* > segResults;	//Completed segments ordered by the timestamp of their last location
 
-	multimap< unsigned, Location* > annoResults;   //Annotated locations ordered by timestamp
+	ColumnarWriter *columnar;		//Writer of the binary columnar output; empty for text output
+	SynopsisWriter *synopsis;		//Writer of blocks per vessel into a synopsis store; empty for other outputs
+	SplitWriter *split;			//Writer of separate files per vessel or bucket; empty for a single output file
+	Formatter *formatter;			//Formatter of rows in the text output; empty for other outputs
+	AsyncWriter *writer;			//Thread writing the formatted rows into the output file
+	Filter *filter;				//Predicates on the locations to be written; empty if all of them qualify
+	IndexWriter *index;			//Spatio-temporal index built alongside the output; empty if none
+	unsigned long numWritten;		//Count written locations
 
-	void setHeader(vector<string>);
+	void writeLocation(Location *, unsigned long, bool);
+	void writeSegments(unsigned int);
+	void flushOutput();
+	void releaseDropped();
 };
 
 #endif /*SINK_H_*/
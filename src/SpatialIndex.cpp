@@ -0,0 +1,224 @@
+//Title: SpatialIndex.cpp
+//Description: Spatio-temporal index over the written locations, partitioned by time slices and grouped by the cells of a uniform grid in each slice.
+//             The index is built by the sink alongside the output and is mapped into memory by the query tool, which only scans records in cells overlapping a query.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "SpatialIndex.h"
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+//Constructor; the header is written at once
+IndexWriter::IndexWriter(const char *fileName, bool includeId)
+{
+    fout.open(fileName, ios::out | ios::binary | ios::trunc);
+    char magic[8] = INDEX_MAGIC;
+    unsigned int flags = (includeId ? 1 : 0);
+    unsigned int timeSlice = INDEX_TIME_SLICE;
+    double cellSize = INDEX_CELL_SIZE;
+    fout.write(magic, sizeof(magic));
+    fout.write((char *)&flags, sizeof(flags));
+    fout.write((char *)&timeSlice, sizeof(timeSlice));
+    fout.write((char *)&cellSize, sizeof(cellSize));
+    closed = false;
+    curSlice = 0;
+    numRecords = 0;
+}
+
+
+//Destructor
+IndexWriter::~IndexWriter()
+{
+    close();
+}
+
+
+//Add a written location at the given position of the output
+//CAUTION! Locations must be appended in ascending timestamps, as in the output
+void IndexWriter::append(Location *p, unsigned long order)
+{
+    if ((p->t / INDEX_TIME_SLICE != curSlice) && !records.empty())
+        writeSlice();
+    curSlice = p->t / INDEX_TIME_SLICE;
+
+    IndexRecord r;
+    r.oid = p->oid;
+    r.order = order;
+    r.x = p->x;
+    r.y = p->y;
+    r.speed = p->speed;
+    r.heading = p->heading;
+    r.t = p->t;
+    r.annotation = p->annotation.to_ulong();
+    records.push_back(r);
+}
+
+
+//Group the records of the current time slice by grid cell and append them to the file, along with a directory entry per cell
+void IndexWriter::writeSlice()
+{
+    vector< pair< pair<int, int>, size_t > > keys;     //Cell of each record, along with its position
+    keys.reserve(records.size());
+    for (size_t i = 0; i < records.size(); i++)
+        keys.push_back(make_pair(make_pair(getIndexCell(records[i].x, INDEX_CELL_SIZE), getIndexCell(records[i].y, INDEX_CELL_SIZE)), i));
+    std::sort(keys.begin(), keys.end());       //Ties are broken by position, so records remain in output order within each cell
+
+    size_t i = 0;
+    while (i < keys.size()) {
+        IndexCell c;
+        c.slice = curSlice;
+        c.cx = keys[i].first.first;
+        c.cy = keys[i].first.second;
+        c.mask = 0;
+        c.tMin = UINT_MAX;
+        c.tMax = 0;
+        c.first = numRecords;
+        c.count = 0;
+        while ((i < keys.size()) && (keys[i].first == make_pair(c.cx, c.cy))) {
+            IndexRecord &r = records[keys[i++].second];
+            fout.write((char *)&r, sizeof(IndexRecord));
+            c.mask |= r.annotation;
+            c.tMin = min(c.tMin, r.t);
+            c.tMax = max(c.tMax, r.t);
+            c.count++;
+        }
+        numRecords += c.count;
+        cells.push_back(c);
+    }
+    records.clear();
+}
+
+
+//Write the remaining records and the directory, then close the file; false if the file could not be written completely
+bool IndexWriter::close()
+{
+    if (closed)
+        return fout.good();
+    closed = true;
+
+    if (!records.empty())
+        writeSlice();
+    unsigned long numCells = cells.size();
+    unsigned long offset = 24 + numRecords * sizeof(IndexRecord);
+    char magic[8] = INDEX_MAGIC;
+    if (!cells.empty())
+        fout.write((char *)&cells[0], numCells * sizeof(IndexCell));
+    fout.write((char *)&numCells, sizeof(numCells));
+    fout.write((char *)&offset, sizeof(offset));
+    fout.write(magic, sizeof(magic));
+    fout.close();
+    return fout.good();
+}
+
+
+//Constructor; the file is mapped into memory and its layout is validated
+IndexReader::IndexReader(const char *fileName)
+{
+    valid = false;
+    hasId = false;
+    data = NULL;
+    length = 0;
+    records = NULL;
+    cells = NULL;
+    numCells = 0;
+    numRecords = 0;
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size < 48)) {
+        ::close(fd);
+        return;
+    }
+    length = st.st_size;
+    void *m = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED)
+        return;
+    data = (char *)m;
+
+    unsigned int flags;
+    unsigned long offset;
+    memcpy(&flags, data + 8, sizeof(flags));
+    memcpy(&timeSlice, data + 12, sizeof(timeSlice));
+    memcpy(&cellSize, data + 16, sizeof(cellSize));
+    memcpy(&numCells, data + length - 24, sizeof(numCells));
+    memcpy(&offset, data + length - 16, sizeof(offset));
+    if ((memcmp(data, INDEX_MAGIC, 8) != 0) || (memcmp(data + length - 8, INDEX_MAGIC, 8) != 0) || (timeSlice == 0) || !(cellSize > 0.0))
+        return;
+    if ((offset < 24) || ((offset - 24) % sizeof(IndexRecord) != 0) || (offset > length - 24) || ((length - 24 - offset) != numCells * sizeof(IndexCell)))
+        return;
+    numRecords = (offset - 24) / sizeof(IndexRecord);
+    records = (const IndexRecord *)(data + 24);
+    cells = (const IndexCell *)(data + offset);
+    for (unsigned long k = 0; k < numCells; k++)
+        if (cells[k].first + cells[k].count > numRecords)
+            return;
+    hasId = (flags & 1);
+    valid = true;
+}
+
+
+//Destructor
+IndexReader::~IndexReader()
+{
+    if (data != NULL)
+        munmap(data, length);
+}
+
+
+//Check whether this is a valid index file
+bool IndexReader::good()
+{
+    return valid;
+}
+
+
+//Check whether identifiers are included in the indexed output
+bool IndexReader::includesId()
+{
+    return hasId;
+}
+
+
+//Number of indexed locations
+unsigned long IndexReader::countRecords()
+{
+    return numRecords;
+}
+
+
+//Collect all records within a bounding box (inclusive) and a range of timestamps (inclusive), bearing at least one of the given annotation bits (any, if zero)
+//Only cells of the overlapping time slices with some overlap in space, time and annotations are scanned; results are in output order
+void IndexReader::query(double x1, double y1, double x2, double y2, unsigned int t1, unsigned int t2, unsigned int mask, vector<const IndexRecord*> &results)
+{
+    if (!valid)
+        return;
+    double minX = min(x1, x2), maxX = max(x1, x2), minY = min(y1, y2), maxY = max(y1, y2);
+    unsigned int tMin = min(t1, t2), tMax = max(t1, t2);
+    int cx1 = getIndexCell(minX, cellSize), cx2 = getIndexCell(maxX, cellSize);
+    int cy1 = getIndexCell(minY, cellSize), cy2 = getIndexCell(maxY, cellSize);
+
+    //Directory entries are in ascending time slices, so the first overlapping one is found by binary search
+    const IndexCell *c = std::lower_bound(cells, cells + numCells, tMin / timeSlice, [](const IndexCell &a, unsigned int s) { return a.slice < s; });
+    size_t numBefore = results.size();
+    for (; (c != cells + numCells) && (c->slice <= tMax / timeSlice); c++) {
+        if ((c->cx < cx1) || (c->cx > cx2) || (c->cy < cy1) || (c->cy > cy2) || (c->tMax < tMin) || (c->tMin > tMax) || ((mask != 0) && ((c->mask & mask) == 0)))
+            continue;
+        for (const IndexRecord *r = records + c->first; r != records + c->first + c->count; r++) {
+            if ((r->t < tMin) || (r->t > tMax) || ((mask != 0) && ((r->annotation & mask) == 0)))
+                continue;
+            if ((r->x < minX) || (r->x > maxX) || (r->y < minY) || (r->y > maxY))
+                continue;
+            results.push_back(r);
+        }
+    }
+    std::sort(results.begin() + numBefore, results.end(), [](const IndexRecord *a, const IndexRecord *b) { return a->order < b->order; });
+}
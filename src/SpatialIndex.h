@@ -0,0 +1,106 @@
+#ifndef SPATIALINDEX_H_
+#define SPATIALINDEX_H_
+
+#include "Location.h"
+#include <vector>
+#include <fstream>
+#include <cmath>
+#include <climits>
+
+using namespace std;
+
+
+//Layout of an index file:
+//  header:    magic (8 bytes), flags (4 bytes; bit 0: identifiers included), time slice (4 bytes, in seconds), cell size (double, in degrees)
+//  records:   IndexRecord per written location, grouped by time slice, then by grid cell, then in output order
+//  directory: IndexCell per (time slice, grid cell) with records, in ascending time slice
+//  footer:    number of cells (8 bytes), offset of directory (8 bytes), magic (8 bytes)
+#define INDEX_MAGIC "AISIDX1"
+#define INDEX_CELL_SIZE 0.1		//Side (in degrees) of the cells of the spatial grid
+#define INDEX_TIME_SLICE 86400		//Span (in seconds) of each time partition of the index
+
+
+//Grid cell (column or row) of a coordinate; out of range coordinates fall into the outermost cells
+inline int getIndexCell(double v, double cellSize)
+{
+	double c = floor(v / cellSize);
+	if (!(c > INT_MIN))
+		return INT_MIN;
+	if (c > INT_MAX)
+		return INT_MAX;
+	return (int)c;
+}
+
+
+//Location as stored in an index file
+struct IndexRecord {
+	long oid;
+	unsigned long order;		//Position of the row in the output
+	double x;
+	double y;
+	double speed;
+	double heading;
+	unsigned int t;
+	unsigned int annotation;	//Annotation bits as in Location
+};
+
+
+//Entry in the directory of an index file for the records of a time slice within a grid cell
+struct IndexCell {
+	unsigned int slice;		//Time slice, i.e., timestamp divided by the span of slices
+	int cx;				//Column of the grid cell (longitude)
+	int cy;				//Row of the grid cell (latitude)
+	unsigned int mask;		//Union of annotation bits of its records
+	unsigned int tMin, tMax;	//Range of timestamps of its records
+	unsigned long first;		//Position of its first record
+	unsigned long count;		//Number of its records
+};
+
+
+//Class for building an index file alongside the output, as rows are written in ascending timestamps
+//Records of the current time slice are kept in memory; once a later slice starts, they are grouped by cell and appended to the file, so memory is bounded by a single slice
+class IndexWriter {
+public:
+	IndexWriter(const char *, bool);
+	~IndexWriter();
+
+	void append(Location *, unsigned long);
+	bool close();
+
+private:
+	ofstream fout;
+	bool closed;
+	unsigned int curSlice;			//Time slice of the collected records
+	vector<IndexRecord> records;		//Records of the current time slice
+	vector<IndexCell> cells;		//Directory of all cells written so far
+	unsigned long numRecords;		//Records written so far
+
+	void writeSlice();
+};
+
+
+//Class for answering range queries over an index file, which is mapped into memory
+class IndexReader {
+public:
+	IndexReader(const char *);
+	~IndexReader();
+
+	bool good();
+	bool includesId();
+	unsigned long countRecords();
+	void query(double, double, double, double, unsigned int, unsigned int, unsigned int, vector<const IndexRecord*> &);
+
+private:
+	bool valid;
+	bool hasId;
+	double cellSize;
+	unsigned int timeSlice;
+	char *data;			//Mapped file
+	size_t length;
+	const IndexRecord *records;
+	const IndexCell *cells;
+	unsigned long numCells;
+	unsigned long numRecords;
+};
+
+#endif /*SPATIALINDEX_H_*/
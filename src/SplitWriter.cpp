@@ -0,0 +1,203 @@
+//Title: SplitWriter.cpp
+//Description: Output of multiple vessels into separate files (per vessel or per bucket of vessels) by a pool of writer threads.
+//             Rows arrive in the order of the single output file and are copied into batches per writer; each writer groups a batch by file and appends to each file in turn.
+//             Hence, each file contains exactly the rows of its vessels in the single output file, in the same order.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "SplitWriter.h"
+#include "mobility.h"
+#include <sys/stat.h>
+#include <errno.h>
+
+#define SPLIT_BATCH_SIZE 65536		//Number of rows collected per writer before handing them over
+
+
+//Constructor
+//Files are named after the vessel identifier (e.g., "244660000.csv") or the bucket (e.g., "bucket_7.csv") in the given directory, which is created if missing
+SplitWriter::SplitWriter(const char *outDir, unsigned int numBuckets, unsigned int numWriters, unsigned int maxOpen)
+{
+    this->outDir = outDir;
+    this->numBuckets = numBuckets;
+    this->maxOpen = max(maxOpen / max(numWriters, 1U), 1U);
+    this->closed = false;
+
+    if ((mkdir(outDir, 0755) != 0) && (errno != EEXIST)) {
+        cout << "Cannot create output directory: " << outDir << endl;
+        exit(1);
+    }
+
+    for (unsigned int w = 0; w < max(numWriters, 1U); w++) {
+        SplitWorker *s = new SplitWorker();
+        s->queue = new SpscQueue< vector<Location>* >(16);
+        s->pending = new vector<Location>();
+        s->formatter = new Formatter(true, false);
+        s->failed = false;
+        workers.push_back(s);
+    }
+    for (unsigned int w = 0; w < workers.size(); w++)
+        workers[w]->worker = thread(&SplitWriter::writeBatches, this, workers[w]);
+}
+
+
+//Destructor
+SplitWriter::~SplitWriter()
+{
+    close();
+    for (unsigned int w = 0; w < workers.size(); w++) {
+        delete workers[w]->queue;
+        delete workers[w]->pending;
+        delete workers[w]->formatter;
+        delete workers[w];
+    }
+}
+
+
+//Key of the file of a vessel: its identifier, or its bucket
+unsigned long SplitWriter::getFileKey(long oid)
+{
+    if (numBuckets > 0)
+        return partitionObject(oid, numBuckets);
+    return (unsigned long)oid;
+}
+
+
+//Path to the file with the given key
+string SplitWriter::getFileName(unsigned long key)
+{
+    if (numBuckets > 0)
+        return outDir + "/bucket_" + to_string(key) + ".csv";
+    return outDir + "/" + to_string((long)key) + ".csv";
+}
+
+
+//Collect a copy of a location to be written by the writer of its file
+void SplitWriter::append(Location *p)
+{
+    unsigned long key = getFileKey(p->oid);
+    SplitWorker *s = workers[(numBuckets > 0) ? (key % workers.size()) : hashObject(p->oid, workers.size())];
+    s->pending->push_back(*p);
+    if (s->pending->size() >= SPLIT_BATCH_SIZE) {
+        s->queue->put(s->pending);
+        s->pending = new vector<Location>();
+    }
+}
+
+
+//Hand over all collected rows to the writers
+void SplitWriter::dispatch()
+{
+    for (unsigned int w = 0; w < workers.size(); w++) {
+        if (!workers[w]->pending->empty()) {
+            workers[w]->queue->put(workers[w]->pending);
+            workers[w]->pending = new vector<Location>();
+        }
+    }
+}
+
+
+//Write all remaining rows and wait for the writers to close their files; false if any file could not be opened or written completely
+bool SplitWriter::close()
+{
+    if (!closed) {
+        closed = true;
+        dispatch();
+        for (unsigned int w = 0; w < workers.size(); w++)
+            workers[w]->queue->put(NULL);     //End of output
+        for (unsigned int w = 0; w < workers.size(); w++)
+            workers[w]->worker.join();
+    }
+
+    for (unsigned int w = 0; w < workers.size(); w++)
+        if (workers[w]->failed)
+            return false;
+    return true;
+}
+
+
+//Number of files created so far
+//CAUTION! Only accurate once the writers have been closed
+unsigned long SplitWriter::countFiles()
+{
+    unsigned long n = 0;
+    for (unsigned int w = 0; w < workers.size(); w++)
+        n += workers[w]->files.size();
+    return n;
+}
+
+
+//Get the open stream of a file; a new file starts with a header, whereas a file closed earlier is reopened for appending
+//If too many files are open, the least recently used one is closed
+ofstream *SplitWriter::openFile(SplitWorker *s, unsigned long key)
+{
+    unordered_map< unsigned long, SplitFile >::iterator iterFile = s->files.find(key);
+    if ((iterFile != s->files.end()) && (iterFile->second.out != NULL)) {
+        s->lru.splice(s->lru.begin(), s->lru, iterFile->second.lru);
+        return iterFile->second.out;
+    }
+
+    if (s->lru.size() >= maxOpen) {
+        SplitFile &victim = s->files[s->lru.back()];
+        victim.out->close();
+        if (!victim.out->good())
+            s->failed = true;
+        delete victim.out;
+        victim.out = NULL;
+        s->lru.pop_back();
+    }
+
+    s->lru.push_front(key);
+    ofstream *out;
+    if (iterFile == s->files.end()) {
+        out = new ofstream(getFileName(key).c_str());
+        s->formatter->setOutput(out);
+        s->formatter->writeHeader();
+    }
+    else
+        out = new ofstream(getFileName(key).c_str(), ios::app);
+    SplitFile &f = s->files[key];
+    f.out = out;
+    f.lru = s->lru.begin();
+    return out;
+}
+
+
+//Writer thread: append each batch of rows to their files, one file at a time
+void SplitWriter::writeBatches(SplitWorker *s)
+{
+    vector< pair<unsigned long, Location*> > rows;     //Rows of a batch along with the keys of their files
+    while (true) {
+        vector<Location> *batch = s->queue->take();
+        if (batch == NULL)
+            break;
+
+        //Group the rows by file, keeping their order within each file
+        rows.clear();
+        for (size_t i = 0; i < batch->size(); i++)
+            rows.push_back(make_pair(getFileKey((*batch)[i].oid), &(*batch)[i]));
+        std::stable_sort(rows.begin(), rows.end(), [](const pair<unsigned long, Location*> &a, const pair<unsigned long, Location*> &b) { return a.first < b.first; });
+
+        size_t i = 0;
+        while (i < rows.size()) {
+            s->formatter->setOutput(openFile(s, rows[i].first));
+            unsigned long key = rows[i].first;
+            while ((i < rows.size()) && (rows[i].first == key))
+                s->formatter->writeRow(rows[i++].second, 0);
+            s->formatter->flush();
+        }
+        delete batch;
+    }
+
+    //Close all files still open
+    s->formatter->setOutput((ostream *)NULL);
+    for (list<unsigned long>::iterator it = s->lru.begin(); it != s->lru.end(); it++) {
+        SplitFile &f = s->files[*it];
+        f.out->close();
+        if (!f.out->good())
+            s->failed = true;
+        delete f.out;
+        f.out = NULL;
+    }
+    s->lru.clear();
+}
@@ -0,0 +1,58 @@
+#ifndef SPLITWRITER_H_
+#define SPLITWRITER_H_
+
+#include "Formatter.h"
+#include "SpscQueue.h"
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace std;
+
+
+//Output file handled by a writer thread, along with its position in the list of recently used files
+struct SplitFile {
+	ofstream *out;				//Open stream; empty once closed to respect the limit of open files
+	list<unsigned long>::iterator lru;	//Position in the list of open files (most recently used first)
+};
+
+
+//A writer thread along with the batches of rows it is about to write
+//Each output file is assigned to exactly one writer, so rows of a file are always written in the order they were reported
+struct SplitWorker {
+	SpscQueue< vector<Location>* > *queue;	//Batches of rows (copies of the reported locations) pending to be written
+	vector<Location> *pending;		//Rows collected for the next batch
+	thread worker;
+	Formatter *formatter;
+	unordered_map< unsigned long, SplitFile > files;	//Files created by this writer
+	list<unsigned long> lru;		//Keys of currently open files, most recently used first
+	bool failed;				//Whether any file could not be opened or written completely
+};
+
+
+//Class for writing the output of multiple vessels into separate files: one per vessel, or one per bucket of vessels (by hash of their identifiers)
+//Files are written concurrently by a pool of writer threads, each one keeping a bounded number of open files (least recently used ones are closed and later reopened for appending)
+class SplitWriter {
+public:
+	SplitWriter(const char *, unsigned int, unsigned int, unsigned int);
+	~SplitWriter();
+
+	void append(Location *);
+	void dispatch();
+	bool close();
+	unsigned long countFiles();
+
+private:
+	string outDir;			//Directory of the output files
+	unsigned int numBuckets;	//Number of files (by hash of vessel identifiers); zero for a file per vessel
+	unsigned int maxOpen;		//Maximum number of open files per writer
+	vector<SplitWorker *> workers;
+	bool closed;
+
+	unsigned long getFileKey(long);
+	string getFileName(unsigned long);
+	ofstream *openFile(SplitWorker *, unsigned long);
+	void writeBatches(SplitWorker *);
+};
+
+#endif /*SPLITWRITER_H_*/
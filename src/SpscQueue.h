@@ -0,0 +1,84 @@
+#ifndef SPSCQUEUE_H_
+#define SPSCQUEUE_H_
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+
+//Bounded lock-free queue between a single producer thread and a single consumer thread (ring buffer with a power-of-two capacity)
+//The producer only advances the tail and the consumer only advances the head, so no locks are needed; a full queue applies backpressure to the producer
+template <class T>
+class SpscQueue {
+public:
+	SpscQueue(size_t capacity) {
+		size_t n = 2;
+		while (n < capacity)
+			n <<= 1;
+		slots.resize(n);
+		mask = n - 1;
+		head.store(0);
+		tail.store(0);
+	}
+
+	//Try to append an item; fails if the queue is full
+	bool push(const T &item) {
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) > mask)
+			return false;
+		slots[t & mask] = item;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Try to remove the oldest item; fails if the queue is empty
+	bool pop(T &item) {
+		size_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire))
+			return false;
+		item = slots[h & mask];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Append an item, waiting while the queue is full (backpressure)
+	void put(const T &item) {
+		unsigned int attempts = 0;
+		while (!push(item))
+			backoff(attempts);
+	}
+
+	//Remove the oldest item, waiting while the queue is empty
+	T take() {
+		T item;
+		unsigned int attempts = 0;
+		while (!pop(item))
+			backoff(attempts);
+		return item;
+	}
+
+	//Number of items currently in the queue (approximate if called concurrently)
+	size_t size() {
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+
+private:
+	vector<T> slots;
+	size_t mask;
+	std::atomic<size_t> head;	//Next slot to be consumed; advanced by the consumer only
+	char padding[64];		//Keeps head and tail on separate cache lines, without over-aligning the queue (not honoured by new before C++17)
+	std::atomic<size_t> tail;	//Next slot to be filled; advanced by the producer only
+
+	//Wait before the next attempt: spin briefly, then back off so that an idle thread does not compete with the others for processors
+	static void backoff(unsigned int &attempts) {
+		if (++attempts < 64)
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+};
+
+#endif /*SPSCQUEUE_H_*/
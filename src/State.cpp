@@ -7,6 +7,9 @@
 //Revision: 20/5/2025
 
 #include "State.h"
+#include "Checkpoint.h"
+
+atomic<unsigned long> State::numCentroids(0);
 
 
 //Constructor for the state referring to a specific object
@@ -16,6 +19,7 @@ State::State(long oid, unsigned int t0, Config *config, Sink *sink)
     this->curTime = t0;        	//time of latest refresh; initially coincides with the time that the window is firstly being applied
 
     curConfig = config;   	//Configuration settings for this object
+    configVersion = 0;
 
     //Initialize bitmap: not known status yet
     this->status.reset();
@@ -25,11 +29,138 @@ State::State(long oid, unsigned int t0, Config *config, Sink *sink)
 
     // Output file for reporting locations
     sinkStream = sink;
+    segment = NULL;
+    timer = UINT_MAX;
+    lowerBound = UINT_MAX;
+    lastExpired = NULL;
+
+    //Choose the rule engine according to the settings for this type of vessel
+    this->bindRules();
+}
+
+
+//Bind the rule engine specialized for the compiled-in profile whose thresholds coincide with the configuration of this object
+//If no such profile exists (or specialization is not requested), rules are evaluated against the runtime settings
+void State::bindRules(bool specialize)
+{
+    if (!specialize)
+        applyRules = &State::updateWith<RuntimePolicy>;
+    else if (matchesPolicy<DefaultPolicy>(curConfig))
+        applyRules = &State::updateWith<DefaultPolicy>;
+    else if (matchesPolicy<FishingPolicy>(curConfig))
+        applyRules = &State::updateWith<FishingPolicy>;
+    else if (matchesPolicy<PassengerPolicy>(curConfig))
+        applyRules = &State::updateWith<PassengerPolicy>;
+    else if (matchesPolicy<TankerPolicy>(curConfig))
+        applyRules = &State::updateWith<TankerPolicy>;
+    else if (matchesPolicy<CargoPolicy>(curConfig))
+        applyRules = &State::updateWith<CargoPolicy>;
+    else if (matchesPolicy<TugPolicy>(curConfig))
+        applyRules = &State::updateWith<TugPolicy>;
+    else
+        applyRules = &State::updateWith<RuntimePolicy>;
+}
+
+
+//Apply another configuration from the given version of the settings (e.g., once these are reloaded) to any subsequent updates
+void State::setConfig(Config *config, unsigned int version)
+{
+    curConfig = config;
+    configVersion = version;
+    this->bindRules();
+}
+
+
+//Version of the settings applied to this object
+unsigned int State::getConfigVersion()
+{
+    return configVersion;
+}
+
+
+//Destructor; releases any locations still retained (e.g., once the state is replaced or saved into a snapshot instead of being closed)
+State::~State()
+{
+    for (list <Location *>::iterator it = this->seqPoints.begin(); it != this->seqPoints.end(); ++it)
+        delete *it;
+    delete segment;
+    delete lastExpired;
+}
+
+
+//Redirect any locations reported from now on to another sink
+void State::setSink(Sink *sink)
+{
+    sinkStream = sink;
+}
+
+
+//Serialize the contents of this state (status, latest refresh and retained locations with their features and annotations)
+//Two states with identical fingerprints yield identical annotations for any subsequent locations of this object
+string State::fingerprint()
+{
+    string f;
+    unsigned long bits = this->status.to_ulong();
+    f.append((const char *)&this->curTime, sizeof(this->curTime));
+    f.append((const char *)&bits, sizeof(bits));
+
+    for (list <Location *>::iterator it = this->seqPoints.begin(); it != this->seqPoints.end(); ++it) {
+        Location *p = *it;
+        bits = p->annotation.to_ulong();
+        f.append((const char *)&p->t, sizeof(p->t));
+        f.append((const char *)&p->x, sizeof(p->x));
+        f.append((const char *)&p->y, sizeof(p->y));
+        f.append((const char *)&p->speed, sizeof(p->speed));
+        f.append((const char *)&p->heading, sizeof(p->heading));
+        f.append((const char *)&p->distance, sizeof(p->distance));
+        f.append((const char *)&p->time_elapsed, sizeof(p->time_elapsed));
+        f.append((const char *)&bits, sizeof(bits));
+    }
+
+    return f;
 }
 
 
-//Destructor
-State::~State() {}
+//Append the contents of this state to a snapshot: latest refresh, status, retained locations and the latest one reported upon expiry (if any)
+void State::save(string &buf)
+{
+    unsigned char bits = (unsigned char)this->status.to_ulong();
+    unsigned int n = this->seqPoints.size();
+    unsigned char expired = (lastExpired != NULL);
+    putValue(buf, this->curTime);
+    putValue(buf, bits);
+    putValue(buf, n);
+    for (list <Location *>::iterator it = this->seqPoints.begin(); it != this->seqPoints.end(); ++it)
+        putLocation(buf, *it);
+    putValue(buf, expired);
+    if (expired)
+        putLocation(buf, lastExpired);
+}
+
+
+//Restore the contents of this state from a snapshot
+bool State::load(const char *&p, const char *end)
+{
+    unsigned char bits;
+    unsigned int n;
+    if (!getValue(p, end, this->curTime) || !getValue(p, end, bits) || !getValue(p, end, n))
+        return false;
+    this->status = bitset<3>(bits);
+
+    for (unsigned int i = 0; i < n; i++) {
+        Location *q = getLocation(p, end);
+        if (q == NULL)
+            return false;
+        this->seqPoints.push_back(q);
+    }
+
+    unsigned char expired;
+    if (!getValue(p, end, expired))
+        return false;
+    if (expired && ((lastExpired = getLocation(p, end)) == NULL))
+        return false;
+    return true;
+}
 
 
 //Count locations currently in the state of this object
@@ -71,6 +202,7 @@ double State::getAccumHeading()
 Location* State::getCentroid()
 {
     Location *c = new Location();
+    numCentroids.fetch_add(1, memory_order_relaxed);
 
     //Initialization
     c->x = c->y = 0.0f;
@@ -90,10 +222,18 @@ Location* State::getCentroid()
 }
 
 
+//Number of centroids calculated by all states so far; CAUTION! Callers never release them
+unsigned long State::countCentroids()
+{
+    return numCentroids.load(memory_order_relaxed);
+}
+
+
 //Calculate the centroid of positions accumulated after a stop event started until now
 Location* State::getStopCentroid()
 {
     Location *c = new Location();
+    numCentroids.fetch_add(1, memory_order_relaxed);
 
     //Initialization
     c->x = c->y = 0.0f;
@@ -216,6 +356,14 @@ unsigned int State::getTimespan()
 }
 
 
+//Timestamp of the oldest location retained in the current state; the maximum possible value if the state is empty
+//CAUTION! Annotations of retained locations may still change, so no location at or after this timestamp is final
+unsigned int State::getOldestTimestamp()
+{
+    return (this->seqPoints.empty() ? UINT_MAX : this->seqPoints.front()->t);
+}
+
+
 //Sum up the total displacement across all consecutive locations in the current state
 double State::sumTravelDistance()
 {
@@ -233,9 +381,45 @@ double State::sumTravelDistance()
 }
 
 
+//Report a location expiring from the state, whose annotation is final; if the sink collects segments, the location also extends the current segment
+//A segment starts at a GAP_END or STOP_END and is reported once a GAP_START or STOP_START is reached; segments with a single location are ignored
+void State::report(Location *q)
+{
+    sinkStream->reportPoint(q);
+
+    if (!sinkStream->collectsSegments() || q->isAnnoNoise())
+        return;
+
+    if (q->isAnnoGapEnd() || q->isAnnoStopEnd()) {
+        delete segment;
+        segment = new Segment(q);
+    }
+    else if (segment != NULL)
+        segment->add(q);
+
+    if ((q->isAnnoGapStart() || q->isAnnoStopStart()) && (segment != NULL)) {
+        if (segment->numLocations > 1)
+            sinkStream->reportSegment(segment);
+        else
+            delete segment;
+        segment = NULL;
+    }
+}
+
+
 //Initialize the state with the given location
+//If the state has expired after a gap, the speed and heading of this location are measured from the latest location reported then, as if it had arrived before the expiry
 void State::init(Location *p)
 {
+    if ((lastExpired != NULL) && (p->t > lastExpired->t)) {
+        p->distance = getHaversineDistance(lastExpired->x, lastExpired->y, p->x, p->y);
+        p->time_elapsed = p->t - lastExpired->t;
+        p->speed = (3600.0f * p->distance) / (1852.0f * p->time_elapsed);
+        p->heading = getBearing(lastExpired, p);
+    }
+    delete lastExpired;
+    lastExpired = NULL;
+
     p->setAnnoGapEnd();  		//First, mark this location as GAP_END
     this->seqPoints.push_back(p);   	//Push new location into the sequence
 
@@ -260,16 +444,24 @@ void State::append(Location *p)
 //Update the current state (velocity vector) of this object with a new location, and also eliminate obsolete locations from the queue
 //CAUTION! The locations appended to the state must be checked for irregularities and annotated with any significant mobility features
 void State::update(Location *p)
+{
+    (this->*applyRules)(p);
+}
+
+
+//Apply the mobility rules with the thresholds supplied by the given policy
+template <class P>
+void State::updateWith(Location *p)
 {
     //Basic calculations between the last pair of successive locations of this object
     //Identify previous point in the sequence; already checked that there is at least one point in the current state
     Location *q = this->seqPoints.back();
 
     //STEP #1 (FORWARD check): Determine whether the current location should be characterized as a critical point (except for turning points)
-    this->forwardMobilityCheck(q, p); //characterizes the CURRENT location
+    this->forwardMobilityCheck<P>(q, p); //characterizes the CURRENT location
 
     //STEP #2 (BACKWARD check): Determine whether the previous location should also be characterized as a turning point (where significant change in heading is observed)
-    this->backwardMobilityCheck(q, p); //characterizes the PREVIOUS location
+    this->backwardMobilityCheck<P>(q, p); //characterizes the PREVIOUS location
 
     //Reset stop status
     if (p->isAnnoStopEnd())
@@ -289,7 +481,7 @@ void State::purge()
     while (!this->seqPoints.empty())
     {    
         //Print out this expiring point into the file (including its annotation)    
-        sinkStream->reportPoint(this->seqPoints.front());
+        this->report(this->seqPoints.front());
 
         //Remove it from the sequence    
         this->seqPoints.pop_front();                      
@@ -306,7 +498,7 @@ void State::cleanup()
     while (this->seqPoints.size() > 2)
     {
         //Print out this expiring point into the file (including its annotation)    
-        sinkStream->reportPoint(this->seqPoints.front());
+        this->report(this->seqPoints.front());
 
         //Remove it from the sequence   
         this->seqPoints.pop_front(); 
@@ -428,8 +620,16 @@ bool State::revokeChangeInHeading()
 }
 
 
+//Check whether this object is stopped and retains many more locations than its state size, as none expire from its state until it moves again
+bool State::isPinning()
+{
+    return (this->isStopped() && (this->countLocations() > PINNED_HISTORY_FACTOR * curConfig->state_size));
+}
+
+
 //Apply noise filtering to incoming location (considered as a candidate critical point) w.r.t. to the previously reported one in the state
 //Detect noise and accordingly update the object state (actually the history of recent locations maintained for this particular object)
+template <class P>
 bool State::checkNoise(Location *oldLoc, Location *newLoc)
 {
     //In case this is the first or second location after a GAP, it cannot be considered for NOISE
@@ -438,15 +638,15 @@ bool State::checkNoise(Location *oldLoc, Location *newLoc)
     }
 
     //First, in case of EXCESSIVE speed, this location qualifies for noise
-    if (newLoc->speed >= curConfig->max_speed) {
+    if (newLoc->speed >= P::max_speed(curConfig)) {
 		return true;
     }
     //Also check whether there has been any improbable change of rate in instantaneous speed (i.e., huge acceleration or deceleration)
-    else if ((oldLoc->speed > EPSILON) && (abs(getRateOfChangeKnots(oldLoc, newLoc)) >= curConfig->max_rate_of_change)) {
+    else if ((oldLoc->speed > EPSILON) && (abs(getRateOfChangeKnots(oldLoc, newLoc)) >= P::max_rate_of_change(curConfig))) {
 		return true;                     //Mark this location as noise
     }
     //Next, check if there has been a sudden surge in the rate of turn, provided that the object is NOT stopped (i.e., agility during stop should NOT be considered as noise)
-    else if ((!oldLoc->isAnnoGapEnd()) && (newLoc->speed > curConfig->low_speed) && (getRateOfTurn(newLoc, oldLoc) >= curConfig->max_rate_of_turn)) {
+    else if ((!oldLoc->isAnnoGapEnd()) && (newLoc->speed > P::low_speed(curConfig)) && (getRateOfTurn(newLoc, oldLoc) >= P::max_rate_of_turn(curConfig))) {
 		return true;                     //Mark this location as noise
     }
 
@@ -456,6 +656,7 @@ bool State::checkNoise(Location *oldLoc, Location *newLoc)
 
 //BACKWARD moblity check: Detect any significant change in heading between two consecutive locations
 //... and annotate accordingly the OLDEST location, because at that point the change in course actually took place
+template <class P>
 void State::backwardMobilityCheck(Location *oldLoc, Location *newLoc) 
 {
     //If its previous location is a GAP_END, then artificially set that speed and heading accordingly
@@ -467,9 +668,9 @@ void State::backwardMobilityCheck(Location *oldLoc, Location *newLoc)
     else  {
       //Change of heading above threshold w.r.t. previous heading --> CHANGE_IN_HEADING
       //Compare also with the mean heading over the recent motion history of this object
-      if ((newLoc->speed > curConfig->no_speed) && ((angleDifference(newLoc->heading, oldLoc->heading) > curConfig->angle_threshold) || (abs(this->getAccumHeading()) > curConfig->angle_threshold))) {
+      if ((newLoc->speed > P::no_speed(curConfig)) && ((angleDifference(newLoc->heading, oldLoc->heading) > P::angle_threshold(curConfig)) || (abs(this->getAccumHeading()) > P::angle_threshold(curConfig)))) {
         //In case of low speed, changes in heading may be ignored due to sea drift
-        if ((newLoc->speed < curConfig->low_speed) && (angleDifference(newLoc->heading, this->getMeanHeading()) < 2 * curConfig->angle_threshold))
+        if ((newLoc->speed < P::low_speed(curConfig)) && (angleDifference(newLoc->heading, this->getMeanHeading()) < 2 * P::angle_threshold(curConfig)))
             return;
 
         oldLoc->setAnnoChangeInHeading();
@@ -483,6 +684,7 @@ void State::backwardMobilityCheck(Location *oldLoc, Location *newLoc)
 
 //FORWARD mobility check: Calculate spatiotemporal measures from pairs of consecutive locations per object
 //... and determine suitable annotations for the LATEST reported location
+template <class P>
 void State::forwardMobilityCheck(Location *prevLoc, Location *newLoc) 
 {
     Location *oldLoc; 
@@ -512,7 +714,7 @@ void State::forwardMobilityCheck(Location *prevLoc, Location *newLoc)
     newLoc->heading = getBearing(oldLoc, newLoc);
 
     //Communication has been restored after a time period
-    if (newLoc->time_elapsed > curConfig->gap_period) {
+    if (newLoc->time_elapsed > P::gap_period(curConfig)) {
 
         newLoc->setAnnoGapEnd();   //Mark this critical point as GAP_END
 
@@ -520,7 +722,7 @@ void State::forwardMobilityCheck(Location *prevLoc, Location *newLoc)
         oldLoc->setAnnoGapStart();
 
         //Check if the object remains stopped in the same location after the gap; otherwise, its state must be purged
-        if (this->isStopped() && ((newLoc->distance < curConfig->distance_threshold) || (getStopNetDisplacement(false) < curConfig->distance_threshold))) { 
+        if (this->isStopped() && ((newLoc->distance < P::distance_threshold(curConfig)) || (getStopNetDisplacement(false) < P::distance_threshold(curConfig)))) { 
             this->setStopped();   //Stop event continues
         }
         else {
@@ -531,7 +733,7 @@ void State::forwardMobilityCheck(Location *prevLoc, Location *newLoc)
     }
 
     //Apply filtering w.r.t. NOISE
-    if (checkNoise(oldLoc, newLoc)) {
+    if (checkNoise<P>(oldLoc, newLoc)) {
         newLoc->setAnnoNoise();
         sinkStream->reportPoint(newLoc);
         return;                   //Any further processing is meaningless
@@ -545,8 +747,8 @@ void State::forwardMobilityCheck(Location *prevLoc, Location *newLoc)
       return;
 
     //CAUTION! Both check conditions concerning STOP cannot hold simultaneously!
-    if (!this->isStopped() && (newLoc->speed < curConfig->no_speed) 
-       && ((newLoc->distance < curConfig->distance_threshold) || (getHaversineDistance(newLoc, this->getCentroid()) < curConfig->distance_threshold)) ) {
+    if (!this->isStopped() && (newLoc->speed < P::no_speed(curConfig)) 
+       && ((newLoc->distance < P::distance_threshold(curConfig)) || (getHaversineDistance(newLoc, this->getCentroid()) < P::distance_threshold(curConfig))) ) {
 
         //In case this stop is immediately after a GAP, ...
         if (oldLoc->isAnnoGapEnd())
@@ -568,12 +770,12 @@ void State::forwardMobilityCheck(Location *prevLoc, Location *newLoc)
         }
     }
     //If either criterion holds: significant speed OR distance threshold --> STOP END
-    else if (this->isStopped() && ((newLoc->speed >= curConfig->no_speed) || (newLoc->distance >= curConfig->distance_threshold)) ) {
-        if (getStopNetDisplacement(true) > curConfig->distance_threshold) {   //Not really a stop, probably moving at very slow speed
+    else if (this->isStopped() && ((newLoc->speed >= P::no_speed(curConfig)) || (newLoc->distance >= P::distance_threshold(curConfig))) ) {
+        if (getStopNetDisplacement(true) > P::distance_threshold(curConfig)) {   //Not really a stop, probably moving at very slow speed
             this->revokeStop();   //Invalidate STOP_START
             this->resetStopped();
         }
-        else if (getStopNetDisplacement(false) >= curConfig->distance_threshold) {   //This indeed was a stop, so invalidate any CHANGE_IN_HEADING events during this event
+        else if (getStopNetDisplacement(false) >= P::distance_threshold(curConfig)) {   //This indeed was a stop, so invalidate any CHANGE_IN_HEADING events during this event
             oldLoc->setAnnoStopEnd();
             this->resetStopped();
             this->revokeChangeInHeading();
@@ -585,25 +787,25 @@ void State::forwardMobilityCheck(Location *prevLoc, Location *newLoc)
 
       //Speed ratio threshold exceeded --> CHANGE_IN_SPEED_START
       double mean_speed = this->getMeanSpeed();
-      if ((abs((newLoc->speed - mean_speed) / mean_speed) > curConfig->speed_ratio) && !this->hasSpeedChanged()) {
+      if ((abs((newLoc->speed - mean_speed) / mean_speed) > P::speed_ratio(curConfig)) && !this->hasSpeedChanged()) {
         newLoc->setAnnoChangeInSpeedStart();
         this->setSpeedChanged();
       }
 
       //Speed ratio threshold not exceeded --> CHANGE_IN_SPEED_END
-      if ((abs((newLoc->speed - mean_speed) / mean_speed) <= curConfig->speed_ratio) && this->hasSpeedChanged()) {
+      if ((abs((newLoc->speed - mean_speed) / mean_speed) <= P::speed_ratio(curConfig)) && this->hasSpeedChanged()) {
         newLoc->setAnnoChangeInSpeedEnd();
         this->resetSpeedChanged();
       }
 
       //Low speed threshold --> SLOW_MOTION_START
-      if ((newLoc->speed <= curConfig->low_speed) && (oldLoc->speed > curConfig->low_speed) && !this->isSlowMotion()) {
+      if ((newLoc->speed <= P::low_speed(curConfig)) && (oldLoc->speed > P::low_speed(curConfig)) && !this->isSlowMotion()) {
         newLoc->setAnnoSlowMotionStart();
         this->setSlowMotion();
       }
 
       //Low speed threshold --> SLOW_MOTION_END
-      if ((newLoc->speed > curConfig->low_speed) && (oldLoc->speed <= curConfig->low_speed) && this->isSlowMotion()) {
+      if ((newLoc->speed > P::low_speed(curConfig)) && (oldLoc->speed <= P::low_speed(curConfig)) && this->isSlowMotion()) {
         newLoc->setAnnoSlowMotionEnd();
         this->resetSlowMotion();
       }
@@ -631,7 +833,7 @@ void State::markLastLocationAsGap()
     while (!this->seqPoints.empty()) {    
         //Report this expiring point into the file (including its annotation)    
         q = this->seqPoints.front();
-        sinkStream->reportPoint(q);
+        this->report(q);
 
         //Remove it from the sequence    
         this->seqPoints.pop_front();                       
@@ -652,7 +854,7 @@ void State::expungeObsoleteLocations(unsigned int t)
     //Keep the latest one for checking occasional GAP events
     while ((this->seqPoints.size()>1) && (((q = this->seqPoints.front())->t <= t - curConfig->state_timespan) || (this->countLocations() > curConfig->state_size))) { 
         //Report this expiring point into the file (including its annotation)    
-        sinkStream->reportPoint(q);
+        this->report(q);
 
         //Remove it from the sequence    
         this->seqPoints.pop_front();
@@ -665,3 +867,101 @@ void State::expungeObsoleteLocations(unsigned int t)
         this->status.reset();
 		
 }
+
+
+//Time when the state expires unless another location arrives: its latest location becomes a certain GAP_START after the gap period, and its oldest location becomes obsolete after the state timespan
+//States of stopped objects never expire, since a stop may resume after a gap; the maximum possible value if the state is empty or stopped
+unsigned int State::getExpiry()
+{
+    if (this->seqPoints.empty() || this->isStopped())
+        return UINT_MAX;
+
+    unsigned int expiry = this->seqPoints.back()->t + curConfig->gap_period + 1;
+    if (this->seqPoints.size() > 1)
+        expiry = min(expiry, this->seqPoints.front()->t + curConfig->state_timespan);
+    return expiry;
+}
+
+
+//Expire the state at the given time, provided that no location of this object may arrive with an earlier timestamp
+//After the gap period, the latest location is marked as GAP_START and all locations are reported, as upon arrival of a location after the gap (except that no heading is compared across the gap);
+//its position and time are kept for measuring the next location. Otherwise, only obsolete locations are removed and reported. Stopped objects are left intact.
+void State::expire(unsigned int t)
+{
+    if (this->seqPoints.empty() || this->isStopped())
+        return;
+
+    if (t > this->seqPoints.back()->t + curConfig->gap_period) {
+        this->seqPoints.back()->setAnnoGapStart();
+        lastExpired = new Location(*this->seqPoints.back());
+        this->purge();
+    }
+    else
+        this->expungeObsoleteLocations(t);
+}
+
+
+//Expiry of the timer scheduled for this state; UINT_MAX if none
+unsigned int State::getTimer()
+{
+    return timer;
+}
+
+
+//Keep the expiry of the timer scheduled for this state
+void State::setTimer(unsigned int t)
+{
+    timer = t;
+}
+
+
+//Time when locations of this state become final by the given horizon unless another location arrives: its oldest location is then reported (if others remain),
+//or all its locations once the object has been silent for longer than both the horizon and its gap period; the maximum possible value if the state is empty
+unsigned int State::getFinality(unsigned int horizon)
+{
+    if (this->seqPoints.empty())
+        return UINT_MAX;
+
+    unsigned int finality = this->seqPoints.back()->t + max(horizon, curConfig->gap_period) + 1;
+    if (this->seqPoints.size() > 1)
+        finality = min(finality, this->seqPoints.front()->t + horizon + 1);
+    return finality;
+}
+
+
+//Report the locations retained for longer than the given horizon before time t, as their annotations may not be held back any further (e.g., by a long stop or a vessel gone silent)
+//If the object has been silent for longer than both the horizon and its gap period, its stream is considered ended (see markLastLocationAsGap), except that a copy of its latest location is kept for measuring the next one;
+//otherwise, only the locations beyond the horizon are reported, so a stop is only checked over that horizon. Reports are attributed to the end of the stream of this object, so their order does not depend on when this happens.
+void State::finalize(unsigned int t, unsigned int horizon)
+{
+    if (this->getFinality(horizon) > t)
+        return;
+
+    sinkStream->setTrigger(Sink::endOfStream(oid));
+    if (t > this->seqPoints.back()->t + max(horizon, curConfig->gap_period)) {
+        delete lastExpired;
+        lastExpired = new Location(*this->seqPoints.back());
+        this->markLastLocationAsGap();
+        this->status.reset();
+        return;
+    }
+
+    while ((this->seqPoints.size() > 1) && (this->seqPoints.front()->t + horizon < t)) {
+        this->report(this->seqPoints.front());
+        this->seqPoints.pop_front();
+    }
+}
+
+
+//Lower bound on the oldest timestamp of this state kept by its engine; UINT_MAX if none
+unsigned int State::getLowerBound()
+{
+    return lowerBound;
+}
+
+
+//Keep the lower bound on the oldest timestamp of this state
+void State::setLowerBound(unsigned int t)
+{
+    lowerBound = t;
+}
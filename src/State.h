@@ -2,9 +2,12 @@
 #define STATE_H_
 
 #include "Sink.h"
+#include "Policy.h"
 
 using namespace std;
 
+#define PINNED_HISTORY_FACTOR 100	//A stopped object pins an unusually long history once it retains this many times the locations of its state size
+
 //Class for maintaining the velocity vector and mobility status for a particular moving object (vessel) over a small number of its latest positions across a recent time interval
 class State {
 public:
@@ -17,8 +20,17 @@ public:
     void purge();
     void cleanup();
     void restore(Location *);
+    void bindRules(bool specialize = true);
+    void setConfig(Config *, unsigned int);
+    unsigned int getConfigVersion();
+    void setSink(Sink *);
+    string fingerprint();
+    void save(string &);
+    bool load(const char *&, const char *);
+    unsigned int getOldestTimestamp();
 
     bool isEmpty();
+    unsigned int countLocations();
     bool isStopped();
     void setStopped();
     void resetStopped();
@@ -30,9 +42,18 @@ public:
     void resetSlowMotion();
     bool revokeStop();
     bool revokeChangeInHeading();
+    bool isPinning();
 
     void expungeObsoleteLocations(unsigned int);
     void markLastLocationAsGap();
+    void expire(unsigned int);
+    unsigned int getExpiry();
+    unsigned int getTimer();
+    void setTimer(unsigned int);
+    void finalize(unsigned int, unsigned int);
+    unsigned int getFinality(unsigned int);
+    unsigned int getLowerBound();
+    void setLowerBound(unsigned int);
 
     double getMeanSpeed();
     double getMeanHeading();
@@ -42,28 +63,41 @@ public:
     double getStopNetDisplacement(bool);
     double getStopNetHeading(bool);
     double getDistanceFromStopStart(Location *);
+    static unsigned long countCentroids();
 
 private:
     long oid;                       	//Object identifier
     unsigned int curTime;               //Timestamp of latest update
 
     Config *curConfig;  		//Configuration settings based on vessel type
+    unsigned int configVersion;		//Version of the settings (as reloaded by its engine) that the configuration comes from
 
     //Maintain a sequence of recent, chronologically ordered, noise-free, RAW LOCATIONS per object
     list <Location *> seqPoints;	//List of points currently maintained in the state
 
     bitset<3> status;    //bitmap denoting the current status of an object: 0-bit: STOPPED; 1-bit: SPEED_CHANGED; 2-bit: SLOW_MOTION
 
-    unsigned int countLocations();         
     unsigned int getTimespan();
     double sumTravelDistance();
 
-    bool checkNoise(Location *, Location *);
-    void backwardMobilityCheck(Location *, Location *);
-    void forwardMobilityCheck(Location *, Location *);
+    //Mobility rules instantiated per policy (compile-time profile or runtime settings)
+    void (State::*applyRules)(Location *);     //Rule engine bound to the vessel type of this object
+    template <class P> void updateWith(Location *);
+    template <class P> bool checkNoise(Location *, Location *);
+    template <class P> void backwardMobilityCheck(Location *, Location *);
+    template <class P> void forwardMobilityCheck(Location *, Location *);
 
     Sink *sinkStream;  // Output file for reporting locations
 
+    unsigned int timer;  //Expiry of the timer scheduled for this state (if any) by its engine; UINT_MAX if none
+    unsigned int lowerBound;  //Lower bound on the oldest timestamp of this state kept by its engine for the watermark (if any); UINT_MAX if none
+    Location *lastExpired;  //Copy of the latest location reported once the state expired (if any), so that the next location is measured against it as upon a gap
+
+    Segment *segment;  //Trajectory segment in progress (if collected by the sink), accumulated with each location once reported
+    void report(Location *);
+
+    static atomic<unsigned long> numCentroids;	//Centroids calculated by all states (updated from any thread); these are never released by their callers
+
 };
 
 #endif /*STATE_H_*/
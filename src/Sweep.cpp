@@ -0,0 +1,104 @@
+//Title: Sweep.cpp 
+//Description: Single-pass annotation of the stream under multiple configurations; parsing is done once, and each configuration is handled by its own engine in a separate thread.
+//             Since locations get annotated in place, each engine works on its own copies of the incoming tuples.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "Sweep.h"
+
+
+//Constructor; starts a worker thread per configuration, reporting its results into the corresponding sink
+Sweep::Sweep(vector< map< string, Config* > > *configs, VesselRegistry *info, vector<Sink *> &sinks, bool annotatedOnly, bool groupByVessel, bool proactive, unsigned int horizon)
+{
+    this->numConfigs = configs->size();
+    this->annotatedOnly = annotatedOnly;
+    this->sinks = sinks;
+
+    for (unsigned int k = 0; k < numConfigs; k++) {
+        Engine *engine = new Engine(&configs->at(k), info, sinks[k]);
+        engine->groupByVessel = groupByVessel;
+        engine->proactive = proactive;
+        engine->horizon = horizon;
+        engines.push_back(engine);
+        queues.push_back(new SpscQueue< SharedBatch* >(64));
+    }
+
+    for (unsigned int k = 0; k < numConfigs; k++)
+        workers.push_back(std::thread(&Sweep::work, this, k));
+}
+
+
+//Destructor
+Sweep::~Sweep()
+{
+    for (unsigned int k = 0; k < numConfigs; k++) {
+        delete engines[k];
+        delete queues[k];
+    }
+}
+
+
+//Worker thread: annotate copies of the shared batches under one configuration until the end of the stream, then emit its remaining results
+//After each batch, results before the oldest location retained by this engine (or the next tuple in the input, if earlier) are final, so they are written into its output
+void Sweep::work(unsigned int k)
+{
+    SharedBatch *batch;
+    vector<Location *> copies;
+    unsigned int next;
+
+    while ((batch = queues[k]->take()) != NULL) {
+        next = batch->next;
+        copies.clear();
+        for (vector<Location *>::iterator it = batch->tuples.begin(); it != batch->tuples.end(); it++)
+            copies.push_back(new Location(**it));
+
+        //The last engine to copy this batch releases the parsed tuples
+        if (batch->pending.fetch_sub(1) == 1) {
+            for (vector<Location *>::iterator it = batch->tuples.begin(); it != batch->tuples.end(); it++)
+                delete *it;
+            delete batch;
+        }
+
+        engines[k]->process(copies);
+        sinks[k]->flush(min(engines[k]->oldestTimestamp(), next), annotatedOnly);
+    }
+
+    //Once the stream is exhausted, expunge any remaining positions and store all results of this configuration into its output file
+    engines[k]->close();
+    sinks[k]->flush(UINT_MAX, annotatedOnly);
+}
+
+
+//Fan out a batch of parsed tuples to all engines, along with the timestamp of the next tuple in the input
+void Sweep::process(vector<Location *> &inTuples, unsigned int next)
+{
+    if (inTuples.empty())
+        return;
+
+    SharedBatch *batch = new SharedBatch();
+    batch->tuples = inTuples;
+    batch->next = next;
+    batch->pending.store(numConfigs);
+
+    for (unsigned int k = 0; k < numConfigs; k++)
+        queues[k]->put(batch);   //Waits if this engine lags behind (backpressure)
+}
+
+
+//Once the stream is exhausted, wait until all engines have emitted their results
+void Sweep::close()
+{
+    for (unsigned int k = 0; k < numConfigs; k++)
+        queues[k]->put(NULL);
+    for (unsigned int k = 0; k < numConfigs; k++)
+        workers[k].join();
+    workers.clear();
+}
+
+
+//Number of objects monitored (the same under any configuration)
+unsigned int Sweep::countStates()
+{
+    return (numConfigs > 0) ? engines[0]->countStates() : 0;
+}
@@ -0,0 +1,40 @@
+#ifndef SWEEP_H_
+#define SWEEP_H_
+
+#include "Engine.h"
+#include "SpscQueue.h"
+
+using namespace std;
+
+
+//Class for annotating a stream under multiple alternative configurations at once (e.g., when tuning parameters)
+//Each tuple is parsed once and fanned out to independent engines, one per configuration, running in their own threads and writing their own output files progressively
+class Sweep {
+public:
+	Sweep(vector< map< string, Config* > > *, VesselRegistry *, vector<Sink *> &, bool, bool, bool = false, unsigned int = 0);
+	~Sweep();
+
+	void process(vector<Location *> &, unsigned int = UINT_MAX);
+	void close();
+
+	unsigned int countStates();
+
+private:
+	//Batch of tuples shared by all engines; each one annotates its own copies of these locations
+	struct SharedBatch {
+		vector<Location *> tuples;
+		unsigned int next;			//Timestamp of the next tuple in the input
+		std::atomic<unsigned int> pending;	//Engines that have not copied this batch yet; the last one releases it
+	};
+
+	unsigned int numConfigs;
+	bool annotatedOnly;
+	vector<Engine *> engines;			//Engine per configuration
+	vector<Sink *> sinks;				//Output sink per configuration
+	vector< SpscQueue< SharedBatch* > *> queues;	//Batches for each engine; an empty pointer signifies the end of the stream
+	vector<std::thread> workers;
+
+	void work(unsigned int);
+};
+
+#endif /*SWEEP_H_*/
@@ -0,0 +1,379 @@
+//Title: Synopsis.cpp
+//Description: Compact store of vessel synopses (annotated locations) in blocks per vessel, with delta/zigzag varint timestamps, fixed-point coordinates and run-length coded annotations.
+//             The sink appends to the store, and a block index by vessel and time gives random access to the synopsis of any vessel.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "Synopsis.h"
+#include <algorithm>
+
+
+//Constructor; if the store already exists, blocks are appended to it
+SynopsisWriter::SynopsisWriter(const char *fileName, bool includeId)
+{
+    string indexName = string(fileName) + ".blk";
+    unsigned int flags = includeId ? 1 : 0;
+    numPending = 0;
+    numBlocks = 0;
+
+    //Check the header of an existing store
+    ifstream fin(fileName, ios::in | ios::binary | ios::ate);
+    if (fin.is_open() && (fin.tellg() > 0)) {
+        offset = fin.tellg();
+        char magic[8];
+        unsigned int storedFlags = 0;
+        ifstream fidx(indexName.c_str(), ios::in | ios::binary);
+        char indexMagic[8];
+        fin.seekg(0);
+        if (!fin.read(magic, sizeof(magic)) || (memcmp(magic, SYNOPSIS_MAGIC, sizeof(magic)) != 0) || !fin.read((char *)&storedFlags, sizeof(storedFlags))
+            || !fidx.read(indexMagic, sizeof(indexMagic)) || (memcmp(indexMagic, SYNOPSIS_INDEX_MAGIC, sizeof(indexMagic)) != 0)) {
+            cout << "Existing file " << fileName << " is not a synopsis store (or its index " << indexName << " is missing)." << endl;
+            exit(1);
+        }
+        if (storedFlags != flags) {
+            cout << "Existing synopsis store " << fileName << " does not match the inclusion of identifiers in the output." << endl;
+            exit(1);
+        }
+        fout.open(fileName, ios::out | ios::binary | ios::app);
+        findex.open(indexName.c_str(), ios::out | ios::binary | ios::app);
+        return;
+    }
+
+    //Create a new store
+    char magic[8] = SYNOPSIS_MAGIC;
+    char indexMagic[8] = SYNOPSIS_INDEX_MAGIC;
+    fout.open(fileName, ios::out | ios::binary | ios::trunc);
+    fout.write(magic, sizeof(magic));
+    fout.write((const char *)&flags, sizeof(flags));
+    offset = sizeof(magic) + sizeof(flags);
+    findex.open(indexName.c_str(), ios::out | ios::binary | ios::trunc);
+    findex.write(indexMagic, sizeof(indexMagic));
+}
+
+
+//Destructor
+SynopsisWriter::~SynopsisWriter()
+{
+    close();
+}
+
+
+//Collect a location of a vessel; the rows of the vessel are written as a block once they are enough
+//CAUTION! Locations of each vessel must be appended in ascending timestamps, as in the output
+void SynopsisWriter::append(Location *p)
+{
+    ColumnarRowGroup &rows = pending[p->oid];
+    rows.lon.push_back(p->x);
+    rows.lat.push_back(p->y);
+    rows.t.push_back(p->t);
+    rows.speed.push_back(p->speed);
+    rows.heading.push_back(p->heading);
+    rows.annotation.push_back((unsigned short)(p->annotation.to_ulong() & ((1 << 10) - 1)));
+    numPending++;
+
+    if (rows.size() >= SYNOPSIS_BLOCK_ROWS) {
+        numPending -= rows.size();
+        writeBlock(p->oid, rows);
+        pending.erase(p->oid);
+    }
+    else if (numPending >= SYNOPSIS_PENDING_ROWS)
+        writeAll();
+}
+
+
+//Write the pending rows of all vessels (in ascending identifiers), then close the store; false if the store or its index could not be written completely
+bool SynopsisWriter::close()
+{
+    if (fout.is_open()) {
+        writeAll();
+        fout.close();
+        findex.close();
+    }
+    return fout.good() && findex.good();
+}
+
+
+//Number of blocks written so far
+unsigned long SynopsisWriter::countBlocks()
+{
+    return numBlocks;
+}
+
+
+//Write a block with the pending rows of each vessel; bounds memory regardless of the number of vessels
+void SynopsisWriter::writeAll()
+{
+    vector<long> vessels;
+    for (unordered_map< long, ColumnarRowGroup >::iterator it = pending.begin(); it != pending.end(); it++)
+        vessels.push_back(it->first);
+    sort(vessels.begin(), vessels.end());
+    for (size_t i = 0; i < vessels.size(); i++)
+        writeBlock(vessels[i], pending[vessels[i]]);
+    pending.clear();
+    numPending = 0;
+}
+
+
+//Encode the rows of a vessel into a block and append it to the data file, along with its entry in the index
+void SynopsisWriter::writeBlock(long oid, ColumnarRowGroup &rows)
+{
+    if (rows.size() == 0)
+        return;
+
+    encoded.clear();
+    unsigned long prev = 0;
+    for (size_t i = 0; i < rows.size(); i++) {
+        appendVarint(encoded, zigzag((long)(rows.t[i] - prev)));
+        prev = rows.t[i];
+    }
+    encodeDoubles(rows.lon);
+    encodeDoubles(rows.lat);
+    encodeDoubles(rows.speed);
+    encodeDoubles(rows.heading);
+
+    //Runs of equal annotations; most locations in a synopsis carry the same few annotations
+    vector< pair<unsigned short, unsigned long> > runs;
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (!runs.empty() && (runs.back().first == rows.annotation[i]))
+            runs.back().second++;
+        else
+            runs.push_back(make_pair(rows.annotation[i], 1UL));
+    }
+    appendVarint(encoded, runs.size());
+    for (size_t i = 0; i < runs.size(); i++) {
+        appendVarint(encoded, runs[i].first);
+        appendVarint(encoded, runs[i].second);
+    }
+
+    SynopsisBlock b;
+    b.oid = oid;
+    b.tMin = *min_element(rows.t.begin(), rows.t.end());
+    b.tMax = *max_element(rows.t.begin(), rows.t.end());
+    b.offset = offset;
+    b.size = encoded.size();
+    b.count = rows.size();
+    fout.write((const char *)&b.oid, sizeof(b.oid));
+    fout.write((const char *)&b.count, sizeof(b.count));
+    fout.write((const char *)&b.size, sizeof(b.size));
+    fout.write(encoded.data(), encoded.size());
+    findex.write((const char *)&b, sizeof(b));
+    offset += sizeof(b.oid) + sizeof(b.count) + sizeof(b.size) + encoded.size();
+    numBlocks++;
+}
+
+
+//Encode a column of doubles as zigzag differences of fixed-point integers, or as raw values if some cannot be printed exactly from such integers
+void SynopsisWriter::encodeDoubles(vector<double> &column)
+{
+    vector<long> values(column.size());
+    for (size_t i = 0; i < column.size(); i++) {
+        if (!toFixedPoint(column[i], values[i])) {
+            encoded += (char)ENCODING_DOUBLE;
+            encoded.append((const char *)column.data(), column.size() * sizeof(double));
+            return;
+        }
+    }
+
+    encoded += (char)ENCODING_FIXED;
+    long prev = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        appendVarint(encoded, zigzag((long)((unsigned long)values[i] - (unsigned long)prev)));
+        prev = values[i];
+    }
+}
+
+
+//Constructor; loads the block index of the store
+SynopsisReader::SynopsisReader(const char *fileName)
+{
+    fin.open(fileName, ios::in | ios::binary);
+    ifstream fidx((string(fileName) + ".blk").c_str(), ios::in | ios::binary);
+
+    char magic[8], indexMagic[8];
+    unsigned int flags = 0;
+    valid = (fin.read(magic, sizeof(magic)) && (memcmp(magic, SYNOPSIS_MAGIC, sizeof(magic)) == 0) && fin.read((char *)&flags, sizeof(flags))
+             && fidx.read(indexMagic, sizeof(indexMagic)) && (memcmp(indexMagic, SYNOPSIS_INDEX_MAGIC, sizeof(indexMagic)) == 0));
+    hasId = (flags & 1);
+
+    SynopsisBlock b;
+    while (valid && fidx.read((char *)&b, sizeof(b)))
+        blocks.push_back(b);
+
+    //Blocks of each vessel by time; blocks appended later come last among those starting at the same time
+    stable_sort(blocks.begin(), blocks.end(), [](const SynopsisBlock &a, const SynopsisBlock &b) { return (a.oid != b.oid) ? (a.oid < b.oid) : (a.tMin < b.tMin); });
+}
+
+
+//Destructor
+SynopsisReader::~SynopsisReader()
+{
+    fin.close();
+}
+
+
+//Check whether this is a valid synopsis store (or no errors occurred while reading it)
+bool SynopsisReader::good()
+{
+    return valid;
+}
+
+
+//Check whether identifiers are included in this store
+bool SynopsisReader::includesId()
+{
+    return hasId;
+}
+
+
+//Identifiers of all vessels in the store, in ascending order
+void SynopsisReader::getVessels(vector<long> &vessels)
+{
+    vessels.clear();
+    for (size_t i = 0; i < blocks.size(); i++)
+        if (vessels.empty() || (vessels.back() != blocks[i].oid))
+            vessels.push_back(blocks[i].oid);
+}
+
+
+//Append the locations of a vessel with timestamps in the given range (inclusive) to the given rows, in ascending timestamps
+//Only blocks of this vessel overlapping the range are read; false if any of them is corrupt
+//Blocks of runs appended over overlapping periods may interleave in time, so their rows are then merged by timestamp
+bool SynopsisReader::read(long oid, unsigned int t1, unsigned int t2, ColumnarRowGroup &rows)
+{
+    unsigned int tMin = min(t1, t2), tMax = max(t1, t2);
+    size_t first = rows.size();
+    bool overlapping = false, started = false;
+    unsigned int tLast = 0;                        //Latest timestamp over the blocks read so far
+    vector<SynopsisBlock>::iterator it = lower_bound(blocks.begin(), blocks.end(), oid, [](const SynopsisBlock &b, long oid) { return b.oid < oid; });
+    for (; (it != blocks.end()) && (it->oid == oid) && (it->tMin <= tMax); it++) {
+        if (it->tMax < tMin)
+            continue;
+        if (!decodeBlock(*it, tMin, tMax, rows)) {
+            valid = false;
+            return false;
+        }
+        if (started && (it->tMin < tLast))
+            overlapping = true;
+        tLast = started ? max(tLast, it->tMax) : it->tMax;
+        started = true;
+    }
+    if (overlapping)
+        sortRows(rows, first);
+    return true;
+}
+
+
+//Stable sort of the rows from the given position onwards by ascending timestamp, so that rows of equal timestamps keep the order of their runs
+void SynopsisReader::sortRows(ColumnarRowGroup &rows, size_t first)
+{
+    size_t n = rows.size() - first;
+    vector<size_t> order(n);
+    for (size_t i = 0; i < n; i++)
+        order[i] = first + i;
+    stable_sort(order.begin(), order.end(), [&rows](size_t a, size_t b) { return rows.t[a] < rows.t[b]; });
+
+    ColumnarRowGroup sorted;
+    for (size_t i = 0; i < n; i++) {
+        size_t k = order[i];
+        if (hasId)
+            sorted.id.push_back(rows.id[k]);
+        sorted.lon.push_back(rows.lon[k]);
+        sorted.lat.push_back(rows.lat[k]);
+        sorted.t.push_back(rows.t[k]);
+        sorted.speed.push_back(rows.speed[k]);
+        sorted.heading.push_back(rows.heading[k]);
+        sorted.annotation.push_back(rows.annotation[k]);
+    }
+    if (hasId)
+        copy(sorted.id.begin(), sorted.id.end(), rows.id.begin() + first);
+    copy(sorted.lon.begin(), sorted.lon.end(), rows.lon.begin() + first);
+    copy(sorted.lat.begin(), sorted.lat.end(), rows.lat.begin() + first);
+    copy(sorted.t.begin(), sorted.t.end(), rows.t.begin() + first);
+    copy(sorted.speed.begin(), sorted.speed.end(), rows.speed.begin() + first);
+    copy(sorted.heading.begin(), sorted.heading.end(), rows.heading.begin() + first);
+    copy(sorted.annotation.begin(), sorted.annotation.end(), rows.annotation.begin() + first);
+}
+
+
+//Decode the rows of a block with timestamps in the given range (inclusive)
+bool SynopsisReader::decodeBlock(SynopsisBlock &b, unsigned int tMin, unsigned int tMax, ColumnarRowGroup &rows)
+{
+    long oid;
+    unsigned int count, size;
+    fin.clear();
+    if (!fin.seekg(b.offset) || !fin.read((char *)&oid, sizeof(oid)) || !fin.read((char *)&count, sizeof(count)) || !fin.read((char *)&size, sizeof(size)))
+        return false;
+    if ((oid != b.oid) || (count != b.count) || (size != b.size))
+        return false;
+    encoded.resize(size);
+    if ((size > 0) && !fin.read(&encoded[0], size))
+        return false;
+
+    const unsigned char *c = (const unsigned char *)encoded.data();
+    const unsigned char *end = c + size;
+    vector<unsigned int> t(count);
+    unsigned long v, prev = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        if (!readVarint(c, end, v))
+            return false;
+        prev += (unsigned long)unzigzag(v);
+        t[i] = (unsigned int)prev;
+    }
+    vector<double> lon(count), lat(count), speed(count), heading(count);
+    if (!decodeDoubles(c, end, count, lon) || !decodeDoubles(c, end, count, lat) || !decodeDoubles(c, end, count, speed) || !decodeDoubles(c, end, count, heading))
+        return false;
+    vector<unsigned short> annotation;
+    unsigned long numRuns, bits, length;
+    if (!readVarint(c, end, numRuns))
+        return false;
+    for (unsigned long r = 0; r < numRuns; r++) {
+        if (!readVarint(c, end, bits) || !readVarint(c, end, length) || (annotation.size() + length > count))
+            return false;
+        annotation.insert(annotation.end(), length, (unsigned short)bits);
+    }
+    if ((c != end) || (annotation.size() != count))
+        return false;
+
+    for (unsigned int i = 0; i < count; i++) {
+        if ((t[i] < tMin) || (t[i] > tMax))
+            continue;
+        if (hasId)
+            rows.id.push_back(oid);
+        rows.lon.push_back(lon[i]);
+        rows.lat.push_back(lat[i]);
+        rows.t.push_back(t[i]);
+        rows.speed.push_back(speed[i]);
+        rows.heading.push_back(heading[i]);
+        rows.annotation.push_back(annotation[i]);
+    }
+    return true;
+}
+
+
+//Decode a column of doubles, either fixed-point or raw
+bool SynopsisReader::decodeDoubles(const unsigned char *&c, const unsigned char *end, size_t count, vector<double> &column)
+{
+    if (c == end)
+        return false;
+    unsigned char encoding = *c++;
+    if (encoding == ENCODING_DOUBLE) {
+        if ((size_t)(end - c) < count * sizeof(double))
+            return false;
+        memcpy(column.data(), c, count * sizeof(double));
+        c += count * sizeof(double);
+        return true;
+    }
+    if (encoding != ENCODING_FIXED)
+        return false;
+
+    unsigned long v;
+    long prev = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!readVarint(c, end, v))
+            return false;
+        prev = (long)((unsigned long)prev + (unsigned long)unzigzag(v));
+        column[i] = fromFixedPoint(prev);
+    }
+    return true;
+}
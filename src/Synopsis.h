@@ -0,0 +1,83 @@
+#ifndef SYNOPSIS_H_
+#define SYNOPSIS_H_
+
+#include "Columnar.h"
+#include <unordered_map>
+
+using namespace std;
+
+
+//Synopsis store of annotated locations in blocks per vessel, kept in two files (all numbers in little-endian byte order)
+//  Data file: magic "AISSYN1" (8 bytes, zero-terminated), flags (uint32: bit 0 set if identifiers are included), then a sequence of blocks
+//  Block: identifier (int64), number of rows (uint32), payload size (uint32), payload
+//  Payload: timestamps as zigzag varints of differences between successive values;
+//           lon, lat, speed, heading each as an encoding byte (ENCODING_FIXED or ENCODING_DOUBLE), then fixed-point zigzag varint differences or raw 8-byte values;
+//           annotation bitmasks as a number of runs (varint), then a varint pair (bitmask, length) per run of equal bitmasks
+//  Index file ("[data-file].blk"): magic "AISBLK1" (8 bytes, zero-terminated), then a SynopsisBlock entry per block, in the order of blocks in the data file
+//Both files are only ever appended to, so successive runs may append synopses of later periods into the same store
+#define SYNOPSIS_MAGIC "AISSYN1"
+#define SYNOPSIS_INDEX_MAGIC "AISBLK1"
+#define SYNOPSIS_BLOCK_ROWS 4096		//Maximum number of rows per block
+#define SYNOPSIS_PENDING_ROWS 1048576		//Maximum number of rows pending over all vessels before all blocks are written
+
+
+//Entry in the block index: the vessel of a block, its time range and its position in the data file
+struct SynopsisBlock {
+	long oid;
+	unsigned int tMin;
+	unsigned int tMax;
+	unsigned long offset;		//Offset of the block (including its header) in the data file
+	unsigned int size;		//Size of the payload
+	unsigned int count;		//Number of rows
+};
+
+
+//Class for appending annotated locations into a synopsis store; rows are collected per vessel and written as a block once enough of them are pending
+class SynopsisWriter {
+public:
+	SynopsisWriter(const char *, bool);
+	~SynopsisWriter();
+
+	void append(Location *);
+	bool close();
+	unsigned long countBlocks();
+
+private:
+	ofstream fout;
+	ofstream findex;
+	unsigned long offset;				//Current size of the data file
+	unordered_map< long, ColumnarRowGroup > pending;	//Rows collected per vessel that are not yet written
+	unsigned long numPending;
+	unsigned long numBlocks;
+	string encoded;				//Reusable buffer for the payload of a block
+
+	void writeBlock(long, ColumnarRowGroup &);
+	void writeAll();
+	void encodeDoubles(vector<double> &);
+};
+
+
+//Class for random access to the synopses of vessels in a store
+class SynopsisReader {
+public:
+	SynopsisReader(const char *);
+	~SynopsisReader();
+
+	bool good();
+	bool includesId();
+	void getVessels(vector<long> &);
+	bool read(long, unsigned int, unsigned int, ColumnarRowGroup &);
+
+private:
+	ifstream fin;
+	bool valid;
+	bool hasId;
+	vector<SynopsisBlock> blocks;		//Block index, sorted by vessel, then by time
+	string encoded;				//Reusable buffer for the payload of a block
+
+	bool decodeBlock(SynopsisBlock &, unsigned int, unsigned int, ColumnarRowGroup &);
+	bool decodeDoubles(const unsigned char *&, const unsigned char *, size_t, vector<double> &);
+	void sortRows(ColumnarRowGroup &, size_t);
+};
+
+#endif /*SYNOPSIS_H_*/
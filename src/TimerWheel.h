@@ -0,0 +1,103 @@
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+
+//Hierarchical timer wheel over event time (timestamps in seconds): four levels of 256 slots, one level per byte of a 32-bit timestamp
+//A timer is kept at the highest level where its expiry differs from the current time, in the slot of that byte of its expiry; once the wheel reaches that slot, its timers cascade to lower levels
+//Hence, scheduling a timer takes O(1), and each timer is moved at most three times before it fires, regardless of how far ahead it expires
+template <class T>
+class TimerWheel {
+public:
+	TimerWheel() {
+		now = 0;
+		started = false;
+		for (int level = 0; level < 4; level++) {
+			slots[level].resize(256);
+			counts[level] = 0;
+		}
+	}
+
+	//Schedule a timer; it fires once the wheel reaches its expiry (at once, if already reached)
+	void schedule(unsigned int expiry, const T &item) {
+		if (!started) {
+			now = expiry;
+			started = true;
+		}
+		if (expiry <= now) {
+			due.push_back(make_pair(expiry, item));
+			return;
+		}
+		unsigned int diff = expiry ^ now;
+		int level = (diff >> 24) ? 3 : ((diff >> 16) ? 2 : ((diff >> 8) ? 1 : 0));
+		slots[level][(expiry >> (8 * level)) & 255].push_back(make_pair(expiry, item));
+		counts[level]++;
+	}
+
+	//Advance the wheel up to the given time, collecting all timers expiring at or before it (along with their expiries) in ascending expiry
+	void advance(unsigned int t, vector< pair<unsigned int, T> > &expired) {
+		expired.clear();
+		if (!started) {
+			now = t;
+			started = true;
+		}
+		expired.swap(due);
+		while (now < t) {
+			if (counts[0] + counts[1] + counts[2] + counts[3] == 0) {
+				now = t;        //Nothing scheduled; jump ahead
+				break;
+			}
+			if (counts[0] == 0) {
+				//No timers until the next cascade; skip to the last slot of level 0
+				if ((now | 255) >= t) {
+					now = t;
+					break;
+				}
+				now |= 255;
+			}
+			now++;
+
+			//Move timers of higher levels whose slots are reached, starting from the highest one
+			if ((now & 0xFFFFFF) == 0)
+				cascade(3);
+			if ((now & 0xFFFF) == 0)
+				cascade(2);
+			if ((now & 0xFF) == 0)
+				cascade(1);
+
+			vector< pair<unsigned int, T> > &slot = slots[0][now & 255];
+			counts[0] -= slot.size();
+			expired.insert(expired.end(), slot.begin(), slot.end());
+			slot.clear();
+			expired.insert(expired.end(), due.begin(), due.end());     //Timers cascaded right at their expiry
+			due.clear();
+		}
+	}
+
+	//Number of timers scheduled and not yet fired
+	size_t size() {
+		return counts[0] + counts[1] + counts[2] + counts[3] + due.size();
+	}
+
+private:
+	unsigned int now;			//Current time of the wheel
+	bool started;				//Whether the current time has been set
+	vector< vector< pair<unsigned int, T> > > slots[4];	//Timers per level and slot, along with their expiries
+	size_t counts[4];			//Number of timers per level
+	vector< pair<unsigned int, T> > due;	//Timers scheduled at or before the current time, to be fired at the next advance
+
+	//Reschedule the timers in the slot of the given level reached by the current time
+	void cascade(int level) {
+		vector< pair<unsigned int, T> > moved;
+		moved.swap(slots[level][(now >> (8 * level)) & 255]);
+		counts[level] -= moved.size();
+		for (size_t i = 0; i < moved.size(); i++)
+			schedule(moved[i].first, moved[i].second);
+	}
+};
+
+#endif /*TIMERWHEEL_H_*/
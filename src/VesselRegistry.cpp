@@ -0,0 +1,151 @@
+//Title: VesselRegistry.cpp
+//Description: Registry of vessel types per MMSI, loaded from a CSV file (rows: MMSI;TYPE_CODE;TYPE;DESCRIPTION, after a header) into a sorted flat array.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+#include "VesselRegistry.h"
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <string.h>
+#include <stdlib.h>
+
+
+//Constructor of an empty registry; all vessels are of the "Default" type
+VesselRegistry::VesselRegistry()
+{
+    typeNames.push_back("Default");
+}
+
+
+//Destructor
+VesselRegistry::~VesselRegistry()
+{
+}
+
+
+//Load the registry from a CSV file with a header row; the first row of each MMSI is kept, and rows without an MMSI and a type are skipped
+//The whole file is read at once and scanned in place, without any tokenization into strings other than type names
+bool VesselRegistry::load(const char *fileName)
+{
+    ifstream fin(fileName, ios::in | ios::binary);
+    if (!fin.good())
+        return false;
+    fin.seekg(0, ios::end);
+    string buf(fin.tellg(), '\0');
+    fin.seekg(0);
+    fin.read(&buf[0], buf.size());
+
+    unordered_map< string, unsigned short > typeIndex;
+    for (unsigned int k = 0; k < typeNames.size(); k++)
+        typeIndex[typeNames[k]] = k;
+    vector< pair<long, unsigned short> > entries;
+
+    const char *p = buf.c_str();
+    const char *end = p + buf.size();
+    p = (const char *)memchr(p, '\n', end - p);        //Skip header
+    while ((p != NULL) && (p < end)) {
+        const char *line = p + 1;
+        const char *eol = (const char *)memchr(line, '\n', end - line);
+        if (eol == NULL)
+            eol = end;
+        p = eol;
+
+        //Fields: MMSI, type code, type (up to the next separator or the end of the line)
+        char *next;
+        long oid = strtol(line, &next, 10);
+        if ((next == line) || (*next != ';'))
+            continue;
+        const char *code = (const char *)memchr(next + 1, ';', eol - next - 1);
+        if (code == NULL)
+            continue;
+        const char *typeStart = code + 1;
+        const char *typeEnd = (const char *)memchr(typeStart, ';', eol - typeStart);
+        if (typeEnd == NULL) {
+            typeEnd = eol;
+            if ((typeEnd > typeStart) && (typeEnd[-1] == '\r'))
+                typeEnd--;
+        }
+
+        string name(typeStart, typeEnd - typeStart);
+        unordered_map< string, unsigned short >::iterator it = typeIndex.find(name);
+        if (it == typeIndex.end()) {
+            it = typeIndex.insert(pair< string, unsigned short >(name, typeNames.size())).first;
+            typeNames.push_back(name);
+        }
+        entries.push_back(pair< long, unsigned short >(oid, it->second));
+    }
+
+    //Sort by MMSI, keeping the first row of each one
+    std::stable_sort(entries.begin(), entries.end(), [](const pair<long, unsigned short> &a, const pair<long, unsigned short> &b) { return a.first < b.first; });
+    mmsi.clear();
+    types.clear();
+    mmsi.reserve(entries.size());
+    types.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (!mmsi.empty() && (mmsi.back() == entries[i].first))
+            continue;
+        mmsi.push_back(entries[i].first);
+        types.push_back(entries[i].second);
+    }
+    return true;
+}
+
+
+//Dense index of the type of the given vessel; DEFAULT_VESSEL_TYPE if unknown
+unsigned int VesselRegistry::typeOf(long oid)
+{
+    vector<long>::iterator it = std::lower_bound(mmsi.begin(), mmsi.end(), oid);
+    if ((it == mmsi.end()) || (*it != oid))
+        return DEFAULT_VESSEL_TYPE;
+    return types[it - mmsi.begin()];
+}
+
+
+//Name of the vessel type with the given dense index
+const string& VesselRegistry::getTypeName(unsigned int k)
+{
+    return typeNames[k];
+}
+
+
+//Number of distinct vessel types (including "Default")
+unsigned int VesselRegistry::countTypes()
+{
+    return typeNames.size();
+}
+
+
+//Number of registered vessels
+unsigned long VesselRegistry::size()
+{
+    return mmsi.size();
+}
+
+
+//Identifier of the k-th registered vessel (in ascending MMSI)
+long VesselRegistry::getVessel(unsigned long k)
+{
+    return mmsi[k];
+}
+
+
+//Dense index of the type of the k-th registered vessel (in ascending MMSI)
+unsigned int VesselRegistry::getVesselType(unsigned long k)
+{
+    return types[k];
+}
+
+
+//Resolve the settings for each vessel type (per dense index) from the given configurations; types without any settings get the "Default" ones
+void VesselRegistry::bind(map< string, Config* > *configs, vector<Config *> &typeConfigs)
+{
+    Config *defaultConfig = configs->find("Default")->second;
+    typeConfigs.assign(typeNames.size(), defaultConfig);
+    for (unsigned int k = 0; k < typeNames.size(); k++) {
+        map< string, Config* >::iterator it = configs->find(typeNames[k]);
+        if (it != configs->end())
+            typeConfigs[k] = it->second;
+    }
+}
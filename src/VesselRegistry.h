@@ -0,0 +1,36 @@
+#ifndef VESSELREGISTRY_H_
+#define VESSELREGISTRY_H_
+
+#include "Config.h"
+#include <map>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+#define DEFAULT_VESSEL_TYPE 0		//Dense index of the "Default" type, also given to vessels missing from the registry
+
+
+//Class for the registry of vessel types per MMSI, kept as a flat array sorted by MMSI along with a dense index per vessel type
+//Configuration settings are resolved once per vessel type, so binding a vessel to its settings takes a binary search and an array lookup, without any string comparisons
+class VesselRegistry {
+public:
+	VesselRegistry();
+	~VesselRegistry();
+
+	bool load(const char *);
+	unsigned int typeOf(long);
+	const string& getTypeName(unsigned int);
+	unsigned int countTypes();
+	unsigned long size();
+	long getVessel(unsigned long);
+	unsigned int getVesselType(unsigned long);
+	void bind(map< string, Config* > *, vector<Config *> &);
+
+private:
+	vector<long> mmsi;			//Identifiers of all registered vessels in ascending order
+	vector<unsigned short> types;		//Dense index of the type of each registered vessel (in the same order)
+	vector<string> typeNames;		//Name of each vessel type per dense index
+};
+
+#endif /*VESSELREGISTRY_H_*/
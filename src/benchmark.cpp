@@ -0,0 +1,729 @@
+//Title: benchmark.cpp
+//Description: Benchmark of the mobility rules over synthetic vessel trajectories.
+//             For each compiled-in vessel profile, the same stream is annotated with the rule engine specialized for that profile and with the runtime-dispatched one.
+//             Also compares dispatching each batch of tuples in arrival order against grouping it by vessel, and measures scaling of the sharded engine with threads.
+//             Finally, measures the time to save and load a snapshot of the engine (see Checkpoint.h) for a large number of vessels.
+//             Microbenchmarks of the kernels in mobility.h, the annotation bits of locations and the paths of vessel states come first, or alone with --micro.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+
+#include "ShardedEngine.h"
+#include "Checkpoint.h"
+#include <random>
+
+#define MICRO_SEED 42       //Seed of the random inputs of the microbenchmarks
+
+
+//Synthetic raw position of a vessel
+struct RawPoint {
+    long oid;
+    double x;
+    double y;
+    unsigned t;
+};
+
+
+//Generate a time-ordered stream of positions for the given number of vessels, mixing cruising, turns, stops, slow motion, gaps and noise
+vector<RawPoint> generateStream(unsigned int numVessels, unsigned int numPoints, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    vector<RawPoint> stream;
+    stream.reserve(numVessels * numPoints);
+
+    for (unsigned int v = 1; v <= numVessels; v++) {
+        double x = 23.0 + uni(rng);
+        double y = 37.5 + uni(rng);
+        unsigned t = 1722470400 + (unsigned)(600 * uni(rng));
+        double heading = 360.0 * uni(rng);
+        double speed = 12.0;
+        unsigned int phase = 0;       //0: cruise; 1: turn; 2: stop; 3: slow motion
+        unsigned int phaseLeft = 0;
+
+        for (unsigned int i = 0; i < numPoints; i++) {
+            if (phaseLeft == 0) {
+                double r = uni(rng);
+                phase = (r < 0.55) ? 0 : ((r < 0.75) ? 1 : ((r < 0.9) ? 2 : 3));
+                phaseLeft = 5 + (unsigned int)(40 * uni(rng));
+            }
+            phaseLeft--;
+
+            unsigned dt = 10 + (unsigned)(50 * uni(rng));
+            if (uni(rng) < 0.002)
+                dt += 1000 + (unsigned)(3000 * uni(rng));    //Communication gap
+
+            if (phase == 0) {
+                speed = 10.0 + 4.0 * uni(rng);
+                heading += 2.0 * (uni(rng) - 0.5);
+            }
+            else if (phase == 1) {
+                speed = 8.0 + 2.0 * uni(rng);
+                heading += 15.0 + 10.0 * uni(rng);
+            }
+            else if (phase == 2)
+                speed = 0.05 * uni(rng);
+            else
+                speed = 1.0 + uni(rng);
+            heading = fmod(heading + 360.0, 360.0);
+
+            //Advance position according to speed (knots) and heading (degrees clockwise from North)
+            double d = speed * 1852.0 / 3600.0 * dt;
+            y += d * cos(heading * PI / 180.0) / 111320.0;
+            x += d * sin(heading * PI / 180.0) / (111320.0 * cos(y * PI / 180.0));
+            t += dt;
+
+            RawPoint p = { (long)v, x, y, t };
+            if (uni(rng) < 0.01) {        //Noisy position (GPS error)
+                p.x += 0.05 * (uni(rng) - 0.5);
+                p.y += 0.05 * (uni(rng) - 0.5);
+            }
+            stream.push_back(p);
+        }
+    }
+
+    //Interleave positions of all vessels in chronological order
+    std::stable_sort(stream.begin(), stream.end(), [](const RawPoint &a, const RawPoint &b) { return a.t < b.t; });
+
+    return stream;
+}
+
+
+//Annotate the stream with the given configuration; returns elapsed nanoseconds and collects the resulting annotations
+double runRules(const vector<RawPoint> &stream, Config *config, bool specialize, vector<unsigned long> &annotations)
+{
+    vector<Location> pool(stream.size());
+    for (size_t i = 0; i < stream.size(); i++) {
+        pool[i].oid = stream[i].oid;
+        pool[i].x = stream[i].x;
+        pool[i].y = stream[i].y;
+        pool[i].t = stream[i].t;
+    }
+
+    char nullDevice[] = "/dev/null";
+    Sink *sink = new Sink(nullDevice, true);
+    map< long, State* > states;
+    map< long, State* >::iterator iterState;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pool.size(); i++) {
+        Location *p = &pool[i];
+        iterState = states.find(p->oid);
+        if (iterState == states.end()) {
+            State *s = new State(p->oid, p->t, config, sink);
+            s->bindRules(specialize);
+            s->init(p);
+            states.insert(pair< long, State* >(p->oid, s));
+        }
+        else {
+            iterState->second->expungeObsoleteLocations(p->t);
+            if (iterState->second->isEmpty())
+                iterState->second->init(p);
+            else
+                iterState->second->update(p);
+        }
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    for (iterState = states.begin(); iterState != states.end(); iterState++) {
+        iterState->second->markLastLocationAsGap();
+        iterState->second->purge();
+        delete iterState->second;
+    }
+    delete sink;
+
+    annotations.clear();
+    for (size_t i = 0; i < pool.size(); i++)
+        annotations.push_back(pool[i].annotation.to_ulong());
+
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+
+//Compare the specialized rule engine of a profile against the runtime-dispatched rules over the same stream
+template <class P>
+void benchProfile(const vector<RawPoint> &stream, unsigned int repeats)
+{
+    Config config;
+    applyPolicy<P>(&config);
+
+    vector<unsigned long> annoRuntime, annoStatic;
+    double bestRuntime = 0.0, bestStatic = 0.0;
+
+    for (unsigned int r = 0; r < repeats; r++) {
+        double ns = runRules(stream, &config, false, annoRuntime);
+        if ((r == 0) || (ns < bestRuntime))
+            bestRuntime = ns;
+        ns = runRules(stream, &config, true, annoStatic);
+        if ((r == 0) || (ns < bestStatic))
+            bestStatic = ns;
+    }
+
+    cout << left << setw(12) << P::name() << right
+         << setw(14) << setprecision(2) << fixed << bestRuntime / stream.size()
+         << setw(14) << setprecision(2) << fixed << bestStatic / stream.size()
+         << setw(10) << setprecision(3) << fixed << bestRuntime / bestStatic
+         << (annoRuntime == annoStatic ? "  identical" : "  MISMATCH") << endl;
+}
+
+
+//Annotate the stream in batches of SLIDE seconds, dispatching tuples in arrival order or grouped by vessel, over the given number of threads
+//Returns elapsed nanoseconds and collects the resulting annotations along with the order of locations in the output
+double runDispatch(const vector<RawPoint> &stream, Config *config, bool grouped, unsigned int numThreads, vector<unsigned long> &annotations)
+{
+    vector<Location> pool(stream.size());
+    for (size_t i = 0; i < stream.size(); i++) {
+        pool[i].seq = i + 1;
+        pool[i].oid = stream[i].oid;
+        pool[i].x = stream[i].x;
+        pool[i].y = stream[i].y;
+        pool[i].t = stream[i].t;
+    }
+
+    map< string, Config* > configs;
+    configs.insert(pair< string, Config* >("Default", config));
+    VesselRegistry info;
+
+    char nullDevice[] = "/dev/null";
+    Sink *sink = new Sink(nullDevice, true);
+    ShardedEngine *engine = new ShardedEngine(numThreads, &configs, &info, sink, grouped);
+    vector<Location*> batch;
+
+    double elapsed = 0.0;
+    size_t i = 0;
+    while (i < pool.size()) {
+        //Collect the next batch of tuples
+        batch.clear();
+        unsigned t = pool[i].t + SLIDE;
+        while ((i < pool.size()) && (pool[i].t <= t))
+            batch.push_back(&pool[i++]);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        engine->process(batch);
+        elapsed += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    engine->close();
+    elapsed += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    delete engine;
+    delete sink;
+
+    annotations.clear();
+    for (size_t j = 0; j < pool.size(); j++)
+        annotations.push_back(pool[j].annotation.to_ulong());
+
+    return elapsed;
+}
+
+
+//Report cost per tuple and throughput of a dispatch configuration (best of the given number of runs), checking its annotations against a reference run
+void benchDispatchCase(const string &label, const vector<RawPoint> &stream, Config *config, bool grouped, unsigned int numThreads, unsigned int repeats, vector<unsigned long> &reference)
+{
+    vector<unsigned long> annotations;
+    double best = 0.0;
+    for (unsigned int r = 0; r < repeats; r++) {
+        double ns = runDispatch(stream, config, grouped, numThreads, annotations);
+        if ((r == 0) || (ns < best))
+            best = ns;
+    }
+    if (reference.empty())
+        reference = annotations;
+
+    cout << left << setw(12) << label << right << setw(14) << setprecision(2) << fixed << best / stream.size()
+         << setw(14) << setprecision(0) << fixed << 1.0e9 * stream.size() / best
+         << (annotations == reference ? "  identical" : "  MISMATCH") << endl;
+}
+
+
+//Compare batch throughput when dispatching tuples in arrival order or grouped by vessel, and its scaling with the number of threads
+void benchDispatch(unsigned int numVessels, unsigned int numPoints, unsigned int repeats, unsigned int maxThreads)
+{
+    vector<RawPoint> stream = generateStream(numVessels, numPoints, 7);
+    Config config;
+    vector<unsigned long> reference;
+
+    cout << "Batch dispatch: " << numVessels << " vessels x " << numPoints << " positions, best of " << repeats << " runs" << endl;
+    cout << left << setw(12) << "order" << right << setw(14) << "ns/op" << setw(14) << "tuples/sec" << endl;
+    benchDispatchCase("arrival", stream, &config, false, 1, repeats, reference);
+    benchDispatchCase("grouped", stream, &config, true, 1, repeats, reference);
+
+    cout << endl << "Sharded engine (grouped dispatch per shard), up to " << maxThreads << " threads" << endl;
+    cout << left << setw(12) << "threads" << right << setw(14) << "ns/op" << setw(14) << "tuples/sec" << endl;
+    for (unsigned int n = 1; n <= maxThreads; n *= 2)
+        benchDispatchCase(to_string(n), stream, &config, true, n, repeats, reference);
+}
+
+
+//Time to save a snapshot of an engine monitoring the given number of vessels into a file and to load it into a fresh engine, checking that the states are restored intact
+void benchCheckpoint(unsigned int numVessels, unsigned int numPoints)
+{
+    vector<RawPoint> stream = generateStream(numVessels, numPoints, 11);
+    vector<Location> pool(stream.size());
+    for (size_t i = 0; i < stream.size(); i++) {
+        pool[i].seq = i + 1;
+        pool[i].oid = stream[i].oid;
+        pool[i].x = stream[i].x;
+        pool[i].y = stream[i].y;
+        pool[i].t = stream[i].t;
+    }
+
+    Config *config = new Config();
+    map< string, Config* > configs;
+    configs.insert(pair< string, Config* >("Default", config));
+    VesselRegistry info;
+
+    char nullDevice[] = "/dev/null";
+    char snapshotFile[] = "benchmark.ckp";
+    Sink *sink = new Sink(nullDevice, true);
+    Scan *scan = new Scan(nullDevice, 0);
+    Engine *engine = new Engine(&configs, &info, sink);
+    vector<Location*> batch;
+    size_t i = 0;
+    while (i < pool.size()) {
+        batch.clear();
+        unsigned t = pool[i].t + SLIDE;
+        while ((i < pool.size()) && (pool[i].t <= t))
+            batch.push_back(&pool[i++]);
+        engine->process(batch);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool saved = Checkpoint::save(snapshotFile, engine, sink, scan, stream.back().t);
+    double saveTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    unsigned long bytes = Checkpoint::size(snapshotFile);
+
+    Sink *sinkRestored = new Sink(nullDevice, true);
+    Scan *scanRestored = new Scan(nullDevice, 0);
+    Engine *engineRestored = new Engine(&configs, &info, sinkRestored);
+    unsigned int t;
+    start = std::chrono::steady_clock::now();
+    bool loaded = Checkpoint::load(snapshotFile, engineRestored, sinkRestored, scanRestored, t);
+    double loadTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    remove(snapshotFile);
+
+    map< long, string > before, after;
+    engine->fingerprints(before);
+    engineRestored->fingerprints(after);
+
+    cout << "Checkpoint: " << numVessels << " vessels x " << numPoints << " positions" << endl;
+    cout << right << setw(12) << "states" << setw(14) << "size (MB)" << setw(14) << "save (sec)" << setw(14) << "load (sec)" << setw(14) << "save MB/s" << setw(14) << "load MB/s" << endl;
+    cout << setw(12) << engine->countStates() << setw(14) << setprecision(1) << fixed << bytes / 1048576.0
+         << setw(14) << setprecision(3) << fixed << saveTime << setw(14) << loadTime
+         << setw(14) << setprecision(0) << fixed << bytes / 1048576.0 / saveTime << setw(14) << bytes / 1048576.0 / loadTime
+         << ((saved && loaded && (before == after)) ? "  identical" : "  MISMATCH") << endl;
+
+    sinkRestored->clear();
+    engine->close();        //Pooled locations are not released along with the states
+    delete engineRestored;
+    delete sinkRestored;
+    delete scanRestored;
+    delete engine;
+    delete sink;
+    delete scan;
+    delete config;
+}
+
+
+//Accumulates results of the microbenchmarks, so that the compiler cannot discard the operations being timed
+volatile double microChecksum = 0.0;
+
+
+//Best elapsed nanoseconds over the given number of runs, each one timed by the benchmark itself (excluding its setup)
+template <class F>
+double bestOf(unsigned int repeats, F run)
+{
+    double best = 0.0;
+    for (unsigned int r = 0; r < repeats; r++) {
+        double ns = run();
+        if ((r == 0) || (ns < best))
+            best = ns;
+    }
+    return best;
+}
+
+
+//Nanoseconds elapsed since the given time point
+inline double elapsedSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+//Print the cost per operation and the throughput of a microbenchmark, and also append them as a JSON line into the results file (if any)
+void reportMicro(ofstream *results, const string &name, const string &params, double ns, unsigned long numOps, unsigned int repeats)
+{
+    double nsPerOp = ns / numOps;
+    cout << left << setw(36) << name << setw(20) << params << right << setw(12) << setprecision(2) << fixed << nsPerOp
+         << setw(16) << setprecision(0) << fixed << 1.0e9 / nsPerOp << endl;
+    if (results != NULL)
+        *results << "{\"benchmark\":\"" << name << "\",\"params\":\"" << params << "\",\"ns_per_op\":" << setprecision(3) << fixed << nsPerOp
+                 << ",\"ops_per_sec\":" << setprecision(0) << fixed << 1.0e9 / nsPerOp << ",\"ops\":" << numOps << ",\"repeats\":" << repeats
+                 << ",\"seed\":" << MICRO_SEED << ",\"time\":" << time(0) << "}" << endl;
+}
+
+
+//Positions of a single vessel alternating between cruising and stop episodes of the given number of positions each
+vector<RawPoint> generateStops(unsigned int stopLength, unsigned int numEpisodes, unsigned int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+    vector<RawPoint> stream;
+    double x = 23.5, y = 37.5;
+    unsigned t = 1722470400;
+    for (unsigned int e = 0; e < numEpisodes; e++) {
+        for (unsigned int i = 0; i < 20; i++) {        //Cruising northwards at about 12 knots
+            t += 30;
+            y += 12.0 * 1852.0 / 3600.0 * 30 / 111320.0;
+            RawPoint p = { 1, x, y, t };
+            stream.push_back(p);
+        }
+        for (unsigned int i = 0; i < stopLength; i++) {     //Stationary, with a jitter of about a meter
+            t += 30;
+            RawPoint p = { 1, x + 1.0e-5 * (uni(rng) - 0.5), y + 1.0e-5 * (uni(rng) - 0.5), t };
+            stream.push_back(p);
+        }
+    }
+    return stream;
+}
+
+
+//Feed the stream to vessel states as the engine does (expunge obsolete locations, then update); returns elapsed nanoseconds
+//Reports of expiring locations are dropped by the sink (and released by the states), so that only the cost of the states is measured
+double runStates(const vector<RawPoint> &stream, Config *config)
+{
+    vector<Location*> pool(stream.size());
+    for (size_t i = 0; i < stream.size(); i++) {
+        pool[i] = new Location();
+        pool[i]->oid = stream[i].oid;
+        pool[i]->x = stream[i].x;
+        pool[i]->y = stream[i].y;
+        pool[i]->t = stream[i].t;
+    }
+
+    Sink *sink = new Sink();
+    sink->setTriggerFloor(ULONG_MAX);
+    map< long, State* > states;
+    map< long, State* >::iterator iterState;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pool.size(); i++) {
+        Location *p = pool[i];
+        iterState = states.find(p->oid);
+        if (iterState == states.end()) {
+            State *s = new State(p->oid, p->t, config, sink);
+            s->bindRules();
+            s->init(p);
+            states.insert(pair< long, State* >(p->oid, s));
+        }
+        else {
+            iterState->second->expungeObsoleteLocations(p->t);
+            if (iterState->second->isEmpty())
+                iterState->second->init(p);
+            else
+                iterState->second->update(p);
+        }
+    }
+    double ns = elapsedSince(start);
+
+    for (iterState = states.begin(); iterState != states.end(); iterState++) {
+        iterState->second->purge();
+        delete iterState->second;
+    }
+    delete sink;
+    return ns;
+}
+
+
+//Microbenchmarks of the geometric kernels in mobility.h, the annotation bits of locations and the update, expunge and revoke paths of vessel states
+//Inputs are drawn with a fixed seed, so that successive runs (e.g., before and after a change) measure the same operations
+void benchMicro(unsigned int repeats, ofstream *results)
+{
+    const unsigned int numInputs = 4096;       //Inputs cycled through by each kernel (fit in L1/L2 cache)
+    const unsigned long numOps = 1UL << 22;
+
+    std::mt19937 rng(MICRO_SEED);
+    std::uniform_real_distribution<double> uni(0.0, 1.0);
+    vector<Location> from(numInputs), to(numInputs);
+    for (unsigned int i = 0; i < numInputs; i++) {
+        from[i].oid = to[i].oid = 200000000 + (long)(500000000 * uni(rng));
+        from[i].x = 23.0 + uni(rng);
+        from[i].y = 37.0 + uni(rng);
+        from[i].t = 1722470400 + (unsigned)(86400 * uni(rng));
+        to[i].x = from[i].x + 0.01 * (uni(rng) - 0.5);
+        to[i].y = from[i].y + 0.01 * (uni(rng) - 0.5);
+        to[i].t = from[i].t + 10 + (unsigned)(50 * uni(rng));
+        from[i].speed = 20.0 * uni(rng);
+        from[i].heading = 360.0 * uni(rng);
+        to[i].time_elapsed = to[i].t - from[i].t;
+        to[i].speed = getSpeedKnots(&from[i], &to[i]);
+        to[i].heading = getBearing(&from[i], &to[i]);
+        to[i].annotation = bitset<11>((unsigned long)(1024 * uni(rng)));
+    }
+    Location *p = &from[0];
+    Location *q = &to[0];
+    const unsigned int mask = numInputs - 1;
+
+    cout << "Microbenchmarks: seed " << MICRO_SEED << ", best of " << repeats << " runs" << endl;
+    cout << left << setw(36) << "benchmark" << setw(20) << "params" << right << setw(12) << "ns/op" << setw(16) << "ops/sec" << endl;
+
+    //Kernels of mobility.h over pairs of nearby positions
+    reportMicro(results, "getHaversineDistance", "", bestOf(repeats, [&]() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double c = 0.0;
+        for (unsigned long i = 0; i < numOps; i++)
+            c += getHaversineDistance(p[i & mask].x, p[i & mask].y, q[i & mask].x, q[i & mask].y);
+        double ns = elapsedSince(start);
+        microChecksum += c;
+        return ns; }), numOps, repeats);
+
+    reportMicro(results, "findAzimuth", "", bestOf(repeats, [&]() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double c = 0.0;
+        for (unsigned long i = 0; i < numOps; i++)
+            c += findAzimuth(p[i & mask].x, p[i & mask].y, q[i & mask].x, q[i & mask].y);
+        double ns = elapsedSince(start);
+        microChecksum += c;
+        return ns; }), numOps, repeats);
+
+    reportMicro(results, "getSpeedKnots", "", bestOf(repeats, [&]() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double c = 0.0;
+        for (unsigned long i = 0; i < numOps; i++)
+            c += getSpeedKnots(&p[i & mask], &q[i & mask]);
+        double ns = elapsedSince(start);
+        microChecksum += c;
+        return ns; }), numOps, repeats);
+
+    reportMicro(results, "angleDifference", "", bestOf(repeats, [&]() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double c = 0.0;
+        for (unsigned long i = 0; i < numOps; i++)
+            c += angleDifference(p[i & mask].heading, q[i & mask].heading);
+        double ns = elapsedSince(start);
+        microChecksum += c;
+        return ns; }), numOps, repeats);
+
+    reportMicro(results, "getRateOfChangeKnots", "", bestOf(repeats, [&]() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double c = 0.0;
+        for (unsigned long i = 0; i < numOps; i++)
+            c += getRateOfChangeKnots(&p[i & mask], &q[i & mask]);
+        double ns = elapsedSince(start);
+        microChecksum += c;
+        return ns; }), numOps, repeats);
+
+    reportMicro(results, "getRateOfTurn", "", bestOf(repeats, [&]() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double c = 0.0;
+        for (unsigned long i = 0; i < numOps; i++)
+            c += getRateOfTurn(&p[i & mask], &q[i & mask]);
+        double ns = elapsedSince(start);
+        microChecksum += c;
+        return ns; }), numOps, repeats);
+
+    reportMicro(results, "hashObject", "n=16", bestOf(repeats, [&]() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        unsigned long c = 0;
+        for (unsigned long i = 0; i < numOps; i++)
+            c += hashObject(p[i & mask].oid, 16);
+        double ns = elapsedSince(start);
+        microChecksum += c;
+        return ns; }), numOps, repeats);
+
+    //Annotation bits of locations and their decoding into text
+    reportMicro(results, "Location::annotation set/test/reset", "", bestOf(repeats, [&]() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        unsigned long c = 0;
+        for (unsigned long i = 0; i < numOps; i++) {
+            Location &l = p[i & mask];
+            l.setAnnoChangeInHeading();
+            c += l.isAnnotated() + l.isAnnoStopStart();
+            l.resetAnnoChangeInHeading();
+        }
+        double ns = elapsedSince(start);
+        microChecksum += c;
+        return ns; }), numOps, repeats);
+
+    reportMicro(results, "Location::getAnnotationText", "", bestOf(repeats, [&]() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        unsigned long c = 0;
+        for (unsigned long i = 0; i < numOps; i++)
+            c += q[i & mask].getAnnotationText().size();
+        double ns = elapsedSince(start);
+        microChecksum += c;
+        return ns; }), numOps, repeats);
+
+    reportMicro(results, "Location::decodeAnnotation", "", bestOf(repeats, [&]() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        unsigned long c = 0;
+        for (unsigned long i = 0; i < numOps / 16; i++)
+            c += q[i & mask].decodeAnnotation().size();
+        double ns = elapsedSince(start);
+        microChecksum += c;
+        return ns; }), numOps / 16, repeats);
+
+    //Update of vessel states (including expunge), for different state sizes over the same mixed stream
+    vector<RawPoint> stream = generateStream(64, 4096, MICRO_SEED);
+    const unsigned int stateSizes[] = { 5, 20, 100 };
+    for (unsigned int k = 0; k < 3; k++) {
+        Config config;
+        config.state_size = stateSizes[k];
+        config.state_timespan = 1000000;       //Bounded by size only
+        reportMicro(results, "State::update", "state_size=" + to_string(stateSizes[k]), bestOf(repeats, [&]() { return runStates(stream, &config); }), stream.size(), repeats);
+    }
+
+    //Update of vessel states through stop episodes, during which no locations are expunged
+    const unsigned int stopLengths[] = { 10, 100, 1000 };
+    for (unsigned int k = 0; k < 3; k++) {
+        Config config;
+        vector<RawPoint> stops = generateStops(stopLengths[k], 200000 / (20 + stopLengths[k]), MICRO_SEED);
+        reportMicro(results, "State::update", "stop_length=" + to_string(stopLengths[k]), bestOf(repeats, [&]() { return runStates(stops, &config); }), stops.size(), repeats);
+    }
+
+    //Expunge from a state sliding over a stream of a single vessel, i.e., one location expires per call once the state is full
+    for (unsigned int k = 0; k < 3; k++) {
+        Config config;
+        config.state_size = stateSizes[k];
+        config.state_timespan = 1000000;
+        reportMicro(results, "State::expungeObsoleteLocations", "state_size=" + to_string(stateSizes[k]), bestOf(repeats, [&]() {
+            vector<Location*> pool(numOps / 16);
+            for (size_t i = 0; i < pool.size(); i++) {
+                pool[i] = new Location();
+                pool[i]->t = 1722470400 + 30 * i;
+            }
+            Sink sink;
+            sink.setTriggerFloor(ULONG_MAX);
+            State s(1, pool[0]->t, &config, &sink);
+            s.bindRules();
+            s.init(pool[0]);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (size_t i = 1; i < pool.size(); i++) {
+                s.append(pool[i]);
+                s.expungeObsoleteLocations(pool[i]->t);
+            }
+            double ns = elapsedSince(start);
+            s.purge();
+            return ns; }), numOps / 16, repeats);
+    }
+
+    //Revoke the stop (and the turns during it) at the start of a stop episode spanning the entire state
+    for (unsigned int k = 0; k < 3; k++) {
+        Config config;
+        vector<Location> pool(stopLengths[k]);
+        Sink sink;
+        State s(1, 1722470400, &config, &sink);
+        s.bindRules();
+        s.init(&pool[0]);
+        for (size_t i = 1; i < pool.size(); i++)
+            s.append(&pool[i]);
+        unsigned long numRevokes = numOps / stopLengths[k];
+
+        reportMicro(results, "State::revokeStop", "stop_length=" + to_string(stopLengths[k]), bestOf(repeats, [&]() {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            unsigned long c = 0;
+            for (unsigned long i = 0; i < numRevokes; i++) {
+                pool[0].setAnnoStopStart();
+                c += s.revokeStop();
+            }
+            double ns = elapsedSince(start);
+            microChecksum += c;
+            return ns; }), numRevokes, repeats);
+
+        reportMicro(results, "State::revokeChangeInHeading", "stop_length=" + to_string(stopLengths[k]), bestOf(repeats, [&]() {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            unsigned long c = 0;
+            for (unsigned long i = 0; i < numRevokes; i++) {
+                pool[0].setAnnoStopStart();
+                pool[0].setAnnoChangeInHeading();
+                c += s.revokeChangeInHeading();
+            }
+            double ns = elapsedSince(start);
+            microChecksum += c;
+            return ns; }), numRevokes, repeats);
+        s.purge();
+    }
+}
+
+
+//Print the usage of the benchmark
+void usage(const char *program)
+{
+    cout << "Usage: " << program << " [vessels] [positions-per-vessel] [repeats] [max-threads] [snapshot-vessels]" << endl;
+    cout << "       " << program << " --micro [results-file] [repeats]" << endl;
+}
+
+
+//Check whether the given argument is a positive integer
+bool isPositive(const char *arg)
+{
+    char *end;
+    long v = strtol(arg, &end, 10);
+    return ((end != arg) && (*end == '\0') && (v > 0));
+}
+
+
+//Entry point to the benchmark
+int main(int argc, char* argv[])
+{
+    //Arguments are positional; anything else is rejected before running any benchmark
+    bool micro = (argc > 1) && (string(argv[1]) == "--micro");
+    for (int a = 1; a < argc; a++) {
+        string opt = argv[a];
+        if ((opt == "--help") || (opt == "-h")) {
+            usage(argv[0]);
+            exit(0);
+        }
+        if ((micro && ((a == 1) || (a == 2) || ((a == 3) && isPositive(argv[a])))) || (!micro && (a <= 5) && isPositive(argv[a])))
+            continue;
+        cout << ((opt[0] == '-') ? "Unknown option: " : "Invalid argument: ") << opt << endl;
+        usage(argv[0]);
+        exit(1);
+    }
+
+    //Microbenchmarks only, with their results appended into the given file (if any)
+    if (micro) {
+        ofstream *results = NULL;
+        if (argc > 2) {
+            results = new ofstream(argv[2], ios::out | ios::app);
+            if (!results->good()) {
+                cout << "Cannot write results file " << argv[2] << ". Please check again." << endl;
+                exit(1);
+            }
+        }
+        benchMicro((argc > 3) ? atoi(argv[3]) : 5, results);
+        delete results;
+        return 0;
+    }
+
+    unsigned int numVessels = (argc > 1) ? atoi(argv[1]) : 200;
+    unsigned int numPoints = (argc > 2) ? atoi(argv[2]) : 2000;
+    unsigned int repeats = (argc > 3) ? atoi(argv[3]) : 5;
+    unsigned int maxThreads = (argc > 4) ? atoi(argv[4]) : max(std::thread::hardware_concurrency(), 1U);
+    unsigned int numSnapshotVessels = (argc > 5) ? atoi(argv[5]) : 1000000;
+
+    benchMicro(repeats, NULL);
+
+    cout << endl;
+    vector<RawPoint> stream = generateStream(numVessels, numPoints, 42);
+    cout << "Rule engine: " << numVessels << " vessels x " << numPoints << " positions, best of " << repeats << " runs" << endl;
+    cout << left << setw(12) << "profile" << right << setw(14) << "runtime ns/op" << setw(14) << "static ns/op" << setw(10) << "speedup" << "  annotations" << endl;
+
+    benchProfile<DefaultPolicy>(stream, repeats);
+    benchProfile<FishingPolicy>(stream, repeats);
+    benchProfile<PassengerPolicy>(stream, repeats);
+    benchProfile<TankerPolicy>(stream, repeats);
+    benchProfile<CargoPolicy>(stream, repeats);
+    benchProfile<TugPolicy>(stream, repeats);
+
+    cout << endl;
+    benchDispatch(50 * numVessels, numPoints / 40, repeats, min(maxThreads, 64U));
+
+    cout << endl;
+    benchCheckpoint(numSnapshotVessels, 5);
+
+    return 0;
+}
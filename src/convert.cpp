@@ -0,0 +1,68 @@
+//Title: convert.cpp
+//Description: Convert a binary columnar output file (option --columnar) back into the space delimited text format, identical to the one emitted by the text sink.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+
+#include "Sink.h"
+
+
+//Entry point to the converter
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " [columnar-file] [output-file]" << endl;
+        //EXAMPLE execution command: ./convert vessels_annotated.col vessels_annotated.csv
+        //[columnar-file]: Output of annotate with option --columnar.
+        //[output-file]: Annotated locations in text format (ASCII space delimited).
+        exit(0);
+    }
+
+    unsigned long t_start = get_time_micro();
+    ColumnarReader *reader = new ColumnarReader(argv[1]);
+    if (!reader->good()) {
+        cout << "Input file " << argv[1] << " not found or not in columnar format. Please check again." << endl;
+        exit(1);
+    }
+
+    //Rows are already in output order; the text sink just formats them
+    Sink *sinkStream = new Sink(argv[2], reader->includesId());
+    ColumnarRowGroup rows;
+    unsigned long numRows = 0;
+    unsigned long t_load = 0;
+
+    unsigned long t_proc = get_time_micro();
+    while (reader->next(rows)) {
+        t_load += get_time_micro() - t_proc;
+        for (size_t i = 0; i < rows.size(); i++) {
+            Location *p = new Location();
+            p->oid = reader->includesId() ? rows.id[i] : 0;
+            p->x = rows.lon[i];
+            p->y = rows.lat[i];
+            p->t = rows.t[i];
+            p->speed = rows.speed[i];
+            p->heading = rows.heading[i];
+            p->annotation = bitset<11>(rows.annotation[i]);
+            sinkStream->setTrigger(numRows++);
+            sinkStream->reportPoint(p);
+        }
+        sinkStream->flush(UINT_MAX, false);
+        t_proc = get_time_micro();
+    }
+    t_load += get_time_micro() - t_proc;
+
+    if (!reader->good()) {
+        cout << "Input file " << argv[1] << " is corrupt. Please check again." << endl;
+        exit(1);
+    }
+    sinkStream->emitResults(false);
+
+    cout << "Input: " << argv[1] << " Output: " << argv[2] << " #rows: " << numRows << " ";
+    cout << "Load time (sec): " << t_load / 1.0e6 << " Runtime (sec): " << (get_time_micro() - t_start) / 1.0e6 << endl;
+
+    delete reader;
+    delete sinkStream;
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+//Title: extract.cpp
+//Description: Extract the synopses of vessels from a synopsis store (option --synopsis) into the space delimited text format, with the rows of each vessel in ascending timestamps.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+
+#include "Synopsis.h"
+#include "Formatter.h"
+#include "mobility.h"
+#include <boost/algorithm/string.hpp>
+
+
+//Entry point to the extractor
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " [store-file] [output-file] [options]" << endl;
+        //EXAMPLE execution command: ./extract synopses.syn vessel.csv --vessels 244660000 --time 1722470400,1723075200
+        //[store-file]: Synopsis store appended by annotate with option --synopsis.
+        //[output-file]: Locations of the selected vessels in text format (ASCII space delimited), grouped by vessel (in ascending identifiers).
+        cout << "Options:" << endl;
+        cout << "  --vessels A,B,...   Only the given vessels (default: all vessels in the store)" << endl;
+        cout << "  --time T1,T2        Only locations with timestamps between T1 and T2 (inclusive)" << endl;
+        exit(0);
+    }
+
+    vector<long> vessels;
+    unsigned int t1 = 0, t2 = UINT_MAX;
+    for (int a = 3; a < argc; a++) {
+        string opt = argv[a];
+        if ((opt == "--vessels") && (a + 1 < argc)) {
+            vector<string> ids;
+            boost::split(ids, argv[++a], boost::is_any_of(","));
+            for (size_t i = 0; i < ids.size(); i++)
+                vessels.push_back(atol(ids[i].c_str()));
+        }
+        else if ((opt == "--time") && (a + 1 < argc) && (sscanf(argv[a+1], "%u,%u", &t1, &t2) == 2))
+            a++;
+        else {
+            cout << "Unknown option: " << opt << endl;
+            exit(1);
+        }
+    }
+
+    unsigned long t_start = get_time_micro();
+    SynopsisReader *reader = new SynopsisReader(argv[1]);
+    if (!reader->good()) {
+        cout << "Input file " << argv[1] << " not found or not a synopsis store. Please check again." << endl;
+        exit(1);
+    }
+    if (vessels.empty())
+        reader->getVessels(vessels);
+
+    ofstream fout(argv[2]);
+    Formatter *formatter = new Formatter(reader->includesId(), false);
+    formatter->setOutput(&fout);
+    formatter->writeHeader();
+    ColumnarRowGroup rows;
+    Location p;
+    unsigned long numRows = 0;
+    for (size_t k = 0; k < vessels.size(); k++) {
+        rows.clear();
+        if (!reader->read(vessels[k], t1, t2, rows)) {
+            cout << "Input file " << argv[1] << " is corrupt. Please check again." << endl;
+            exit(1);
+        }
+        for (size_t i = 0; i < rows.size(); i++) {
+            p.oid = vessels[k];
+            p.x = rows.lon[i];
+            p.y = rows.lat[i];
+            p.t = rows.t[i];
+            p.speed = rows.speed[i];
+            p.heading = rows.heading[i];
+            p.annotation = bitset<11>(rows.annotation[i]);
+            formatter->writeRow(&p, 0);
+        }
+        numRows += rows.size();
+    }
+    delete formatter;
+    fout.close();
+
+    cout << "Input: " << argv[1] << " Output: " << argv[2] << " #vessels: " << vessels.size() << " #rows: " << numRows << " ";
+    cout << "Runtime (sec): " << (get_time_micro() - t_start) / 1.0e6 << endl;
+
+    delete reader;
+
+    return 0;
+}
@@ -0,0 +1,370 @@
+//Title: generate.cpp
+//Description: Generate a synthetic stream of AIS positions at a configurable scale, in the input format of annotate (rows: MMSI longitude latitude timestamp), sorted by timestamp.
+//             Vessels and their types are drawn from a vessel information file; each vessel alternates between cruising, turns, stops and slow motion according to a profile of its type,
+//             with communication gaps, GPS noise, duplicate and late messages, and a reporting density that follows the time of day.
+//             Vessels are kept in a calendar ring of slots per second, so each row costs O(1) regardless of the number of vessels, and rows are formatted into buffers written by a separate thread.
+//             The output only depends on the arguments: each vessel draws from its own random generator, seeded by the given seed and its MMSI.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+
+#include "VesselRegistry.h"
+#include "AsyncWriter.h"
+#include "mobility.h"
+
+#define RING_SLOTS 65536            //Slots (seconds) in the calendar ring; exceeds the longest interval between successive reports of a vessel
+#define MAX_GAP 21600               //Longest communication gap (in seconds)
+#define STOP_INTERVAL 180           //Seconds between reports of a stopped vessel, as for AIS class A at anchor
+
+
+//Behaviour of vessels of a type: cruising speed, interval between reports while moving, and cumulative probabilities of cruise, turn, stop and slow motion phases
+struct Profile {
+    const char *type;               //Lowercase part of the type names it applies to
+    double cruiseSpeed;             //Knots
+    unsigned int interval;          //Mean seconds between reports while moving
+    double phaseMix[4];
+};
+
+static const Profile profiles[] = {
+    { "",           10.0, 30, { 0.55, 0.75, 0.90, 1.0 } },      //Default
+    { "passenger",  18.0, 10, { 0.60, 0.75, 0.95, 1.0 } },
+    { "high speed", 30.0, 10, { 0.70, 0.85, 0.98, 1.0 } },
+    { "cargo",      13.0, 20, { 0.70, 0.80, 0.95, 1.0 } },
+    { "tanker",     12.0, 20, { 0.65, 0.75, 0.95, 1.0 } },
+    { "fishing",     6.0, 30, { 0.30, 0.60, 0.75, 1.0 } },
+    { "tug",         7.0, 20, { 0.40, 0.65, 0.85, 1.0 } },
+    { "pleasure",    6.0, 60, { 0.50, 0.70, 0.90, 1.0 } },
+    { "sailing",     5.0, 60, { 0.50, 0.70, 0.90, 1.0 } }
+};
+
+
+//Phases of the motion of a vessel
+enum Phase { CRUISE, TURN, STOP, SLOW_MOTION };
+
+
+//Synthetic vessel with its true position at its next report
+struct SyntheticVessel {
+    long oid;
+    double x;
+    double y;
+    double speed;                   //Knots
+    double heading;                 //Degrees clockwise from North
+    double turnRate;                //Degrees per second during a turn
+    unsigned long rng;              //State of its random generator
+    unsigned int phaseLeft;         //Reports left in the current phase
+    unsigned char phase;
+    unsigned char profile;
+};
+
+
+//Probabilities of irregularities per report, and amplitude of the variation of reporting density over the day
+struct Irregularities {
+    double noise;                   //Position off by up to a few kilometers (GPS error)
+    double duplicates;              //Row written twice (e.g., received by two stations)
+    double late;                    //Position of up to two minutes earlier, stamped on reception
+    double gaps;                    //Vessel falls silent for 15 minutes up to 6 hours
+    double diurnal;                 //Reports are more frequent by this fraction at noon and less frequent at midnight
+};
+
+
+//Uniform random number in [0,1) from the given generator state (splitmix64)
+inline double nextRandom(unsigned long &s)
+{
+    unsigned long z = (s += 0x9E3779B97F4A7C15UL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+    z ^= (z >> 31);
+    return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+//Append an unsigned integer to a buffer
+inline char *putInteger(char *p, unsigned long v)
+{
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = '0' + (v % 10);
+        v /= 10;
+    } while (v > 0);
+    while (n > 0)
+        *p++ = digits[--n];
+    return p;
+}
+
+
+//Append a coordinate with PRECISION decimal digits to a buffer
+inline char *putCoordinate(char *p, double v)
+{
+    static const unsigned long unit = (unsigned long)pow(10.0, PRECISION);
+    long r = lround(v * unit);
+    if (r < 0) {
+        *p++ = '-';
+        r = -r;
+    }
+    p = putInteger(p, r / unit);
+    *p++ = '.';
+    unsigned long f = r % unit;
+    for (int i = PRECISION - 1; i >= 0; i--) {
+        p[i] = '0' + (f % 10);
+        f /= 10;
+    }
+    return p + PRECISION;
+}
+
+
+//Profile for the given type name: the first one whose name is part of it (ignoring case), otherwise the default one
+unsigned char getProfile(string type)
+{
+    transform(type.begin(), type.end(), type.begin(), ::tolower);
+    for (unsigned int k = 1; k < sizeof(profiles) / sizeof(profiles[0]); k++)
+        if (type.find(profiles[k].type) != string::npos)
+            return k;
+    return 0;
+}
+
+
+//Initialize a vessel at a random position in the Eastern Mediterranean
+void initVessel(SyntheticVessel &v, long oid, unsigned char profile, unsigned long seed)
+{
+    v.oid = oid;
+    v.profile = profile;
+    v.rng = seed ^ ((unsigned long)oid * 0xD1B54A32D192ED03UL);
+    v.x = 20.0 + 8.0 * nextRandom(v.rng);
+    v.y = 34.0 + 6.0 * nextRandom(v.rng);
+    v.heading = 360.0 * nextRandom(v.rng);
+    v.speed = 0.0;
+    v.turnRate = 0.0;
+    v.phaseLeft = 0;
+    v.phase = CRUISE;
+}
+
+
+//Factor of the reporting density at the given time of day: 1 + diurnal at noon, 1 - diurnal at midnight (UTC)
+inline double getDensity(unsigned long t, double diurnal)
+{
+    return 1.0 + diurnal * sin(2.0 * PI * ((double)(t % 86400) - 21600.0) / 86400.0);
+}
+
+
+//Choose the phase of a vessel until its next report, and advance its true position to that report; returns the seconds until that report
+unsigned int advanceVessel(SyntheticVessel &v, unsigned long t, Irregularities &irr)
+{
+    const Profile &prof = profiles[v.profile];
+
+    if (v.phaseLeft == 0) {
+        double r = nextRandom(v.rng);
+        v.phase = (r < prof.phaseMix[0]) ? CRUISE : ((r < prof.phaseMix[1]) ? TURN : ((r < prof.phaseMix[2]) ? STOP : SLOW_MOTION));
+        v.phaseLeft = (v.phase == STOP) ? (10 + (unsigned int)(110 * nextRandom(v.rng))) : (5 + (unsigned int)(40 * nextRandom(v.rng)));
+        v.turnRate = ((nextRandom(v.rng) < 0.5) ? -1.0 : 1.0) * (0.5 + 1.5 * nextRandom(v.rng));
+    }
+    v.phaseLeft--;
+
+    if (v.phase == CRUISE) {
+        v.speed = prof.cruiseSpeed * (0.85 + 0.3 * nextRandom(v.rng));
+        v.heading += 2.0 * (nextRandom(v.rng) - 0.5);
+    }
+    else if (v.phase == TURN)
+        v.speed = 0.8 * prof.cruiseSpeed * (0.9 + 0.2 * nextRandom(v.rng));
+    else if (v.phase == STOP)
+        v.speed = 0.0;
+    else
+        v.speed = 0.5 + 1.5 * nextRandom(v.rng);
+
+    //Seconds until the next report, scaled by the density at this time of day; possibly a communication gap
+    double interval = (v.phase == STOP) ? STOP_INTERVAL : prof.interval;
+    unsigned int dt = max(1U, (unsigned int)(interval * (0.5 + nextRandom(v.rng)) / getDensity(t, irr.diurnal)));
+    if (nextRandom(v.rng) < irr.gaps)
+        dt += 900 + (unsigned int)((MAX_GAP - 900) * nextRandom(v.rng));
+
+    //Move along the heading (a turn keeps changing it at the rate of turn)
+    if (v.phase == TURN)
+        v.heading += v.turnRate * min(dt, 60U);
+    v.heading = fmod(v.heading + 360.0, 360.0);
+    double d = v.speed * 1852.0 / 3600.0 * dt;
+    v.y += d * cos(v.heading * PI / 180.0) / 111320.0;
+    v.x += d * sin(v.heading * PI / 180.0) / (111320.0 * cos(v.y * PI / 180.0));
+
+    //Turn back at the borders of the area
+    if ((v.x < 19.0) || (v.x > 30.0) || (v.y < 33.0) || (v.y > 41.0)) {
+        v.heading = fmod(v.heading + 180.0, 360.0);
+        v.x = min(max(v.x, 19.0), 30.0);
+        v.y = min(max(v.y, 33.0), 41.0);
+    }
+    return dt;
+}
+
+
+//Format the report of a vessel at the given time into a buffer, possibly with GPS noise, a stale position or a duplicate row
+char *putReport(char *p, SyntheticVessel &v, unsigned long t, Irregularities &irr, unsigned long &numRows)
+{
+    double x = v.x, y = v.y;
+    double r = nextRandom(v.rng);
+    if (r < irr.noise) {
+        x += 0.05 * (nextRandom(v.rng) - 0.5);
+        y += 0.05 * (nextRandom(v.rng) - 0.5);
+    }
+    else if (r < irr.noise + irr.late) {
+        //Delayed message stamped on reception, hence carrying the position of up to two minutes earlier
+        double d = v.speed * 1852.0 / 3600.0 * (5.0 + 115.0 * nextRandom(v.rng));
+        y -= d * cos(v.heading * PI / 180.0) / 111320.0;
+        x -= d * sin(v.heading * PI / 180.0) / (111320.0 * cos(y * PI / 180.0));
+    }
+    else if (v.phase == STOP) {      //Jitter of about a meter at rest
+        x += 1.0e-5 * (nextRandom(v.rng) - 0.5);
+        y += 1.0e-5 * (nextRandom(v.rng) - 0.5);
+    }
+
+    char *row = p;
+    p = putInteger(p, v.oid);
+    *p++ = DELIMITER;
+    p = putCoordinate(p, x);
+    *p++ = DELIMITER;
+    p = putCoordinate(p, y);
+    *p++ = DELIMITER;
+    p = putInteger(p, t);
+    *p++ = '\n';
+    numRows++;
+
+    if (nextRandom(v.rng) < irr.duplicates) {
+        size_t n = p - row;
+        memcpy(p, row, n);
+        p += n;
+        numRows++;
+    }
+    return p;
+}
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 5) {
+        cout << "Usage: " << argv[0] << " [vessel-info-file] [output-file] [vessels] [duration] [options]" << endl;
+        //EXAMPLE execution command: ./generate vessel_info.csv synthetic.csv 500000 86400 --seed 7
+        //[vessel-info-file]: Vessels (and their types) are drawn from this CSV file, as in annotate; more vessels than registered get the same mix of types.
+        //[output-file]: Synthetic positions (ASCII space delimited rows: MMSI longitude latitude timestamp) sorted by timestamp, as expected by annotate.
+        //[vessels]: Number of vessels.
+        //[duration]: Time span (in seconds) of the stream.
+        cout << "Options:" << endl;
+        cout << "  --seed S            Seed of the random generators (default: 42)" << endl;
+        cout << "  --start T           Timestamp (UNIX epoch) at the start of the stream (default: 1722470400)" << endl;
+        cout << "  --noise P           Probability of a position off by up to a few kilometers (default: 0.01)" << endl;
+        cout << "  --duplicates P      Probability of a row written twice (default: 0.002)" << endl;
+        cout << "  --late P            Probability of a message delayed by up to two minutes, with a stale position (default: 0.002)" << endl;
+        cout << "  --gaps P            Probability of a communication gap after a report (default: 0.0005)" << endl;
+        cout << "  --diurnal A         Variation of reporting density over the day, from 1-A at midnight to 1+A at noon (default: 0.5)" << endl;
+        cout << "  --registry FILE     Also write the vessel information (MMSI and type) of all generated vessels into FILE" << endl;
+        exit(0);
+    }
+
+    unsigned long numVessels = strtoul(argv[3], NULL, 10);
+    unsigned long duration = strtoul(argv[4], NULL, 10);
+    unsigned long seed = 42;
+    unsigned long start = 1722470400;
+    Irregularities irr = { 0.01, 0.002, 0.002, 0.0005, 0.5 };
+    char *registryFile = NULL;
+    for (int a = 5; a < argc; a++) {
+        string opt = argv[a];
+        if ((opt == "--seed") && (a + 1 < argc))
+            seed = strtoul(argv[++a], NULL, 10);
+        else if ((opt == "--start") && (a + 1 < argc))
+            start = strtoul(argv[++a], NULL, 10);
+        else if ((opt == "--noise") && (a + 1 < argc))
+            irr.noise = atof(argv[++a]);
+        else if ((opt == "--duplicates") && (a + 1 < argc))
+            irr.duplicates = atof(argv[++a]);
+        else if ((opt == "--late") && (a + 1 < argc))
+            irr.late = atof(argv[++a]);
+        else if ((opt == "--gaps") && (a + 1 < argc))
+            irr.gaps = atof(argv[++a]);
+        else if ((opt == "--diurnal") && (a + 1 < argc) && (atof(argv[a+1]) >= 0.0) && (atof(argv[a+1]) < 1.0))
+            irr.diurnal = atof(argv[++a]);
+        else if ((opt == "--registry") && (a + 1 < argc))
+            registryFile = argv[++a];
+        else {
+            cout << "Unknown option: " << opt << endl;
+            exit(1);
+        }
+    }
+    if ((numVessels == 0) || (duration == 0)) {
+        cout << "The number of vessels and the duration must be positive." << endl;
+        exit(1);
+    }
+
+    VesselRegistry registry;
+    if (!registry.load(argv[1])) {
+        cout << "Vessel information file " << argv[1] << " not found. Please check again." << endl;
+        exit(1);
+    }
+
+    unsigned int t_start = get_time();
+
+    //Profile per type of vessel
+    vector<unsigned char> typeProfiles;
+    for (unsigned int k = 0; k < registry.countTypes(); k++)
+        typeProfiles.push_back(getProfile(registry.getTypeName(k)));
+
+    //Registered vessels spread over the entire registry; any more vessels get identifiers beyond the registered ones and types drawn from the registered ones
+    vector<SyntheticVessel> vessels(numVessels);
+    vector<unsigned int> vesselTypes(numVessels, DEFAULT_VESSEL_TYPE);
+    unsigned long numRegistered = min(numVessels, registry.size());
+    long nextOid = max(100000000L, (registry.size() > 0) ? registry.getVessel(registry.size() - 1) + 1 : 0L);
+    unsigned long rng = seed;
+    for (unsigned long k = 0; k < numVessels; k++) {
+        long oid;
+        if (k < numRegistered) {
+            unsigned long i = k * registry.size() / numRegistered;
+            oid = registry.getVessel(i);
+            vesselTypes[k] = registry.getVesselType(i);
+        }
+        else {
+            oid = nextOid++;
+            if (registry.size() > 0)
+                vesselTypes[k] = registry.getVesselType((unsigned long)(nextRandom(rng) * registry.size()));
+        }
+        initVessel(vessels[k], oid, typeProfiles[vesselTypes[k]], seed);
+    }
+
+    if (registryFile != NULL) {
+        ofstream fout(registryFile);
+        fout << "MMSI;TYPE_CODE;TYPE;DESCRIPTION\n";
+        for (unsigned long k = 0; k < numVessels; k++)
+            fout << vessels[k].oid << ";0;" << registry.getTypeName(vesselTypes[k]) << ";" << registry.getTypeName(vesselTypes[k]) << "\n";
+    }
+
+    //Calendar ring of vessels due per second; each vessel first reports within its interval from the start
+    vector< vector<unsigned int> > slots(RING_SLOTS);
+    for (unsigned long k = 0; k < numVessels; k++)
+        slots[(start + (unsigned long)(profiles[vessels[k].profile].interval * nextRandom(vessels[k].rng))) % RING_SLOTS].push_back(k);
+
+    AsyncWriter writer(argv[2], false);
+    size_t outLength;
+    char *outBuffer = writer.getBuffer(outLength);
+    unsigned long numRows = 0;
+
+    for (unsigned long t = start; t < start + duration; t++) {
+        vector<unsigned int> &due = slots[t % RING_SLOTS];
+        for (size_t i = 0; i < due.size(); i++) {
+            SyntheticVessel &v = vessels[due[i]];
+            if (outLength + 256 > OUTPUT_BUFFER_SIZE)
+                outBuffer = writer.submit(outBuffer, outLength);
+            outLength = putReport(outBuffer + outLength, v, t, irr, numRows) - outBuffer;
+
+            unsigned int dt = advanceVessel(v, t, irr);
+            slots[(t + dt) % RING_SLOTS].push_back(due[i]);
+        }
+        due.clear();
+    }
+    bool complete = writer.close(outBuffer, outLength);
+
+    cout << "Output: " << argv[2] << " #vessels: " << numVessels << " #rows: " << numRows << " Time span (sec): " << duration
+         << " Runtime (sec): " << (get_time() - t_start) / 1000.0f << endl;
+
+    if (!complete) {
+        cout << "Output is incomplete, as some rows could not be written. Please check again." << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -9,8 +9,15 @@
 //Issues not yet resolved:
 
 
-#include "State.h"
+#include "ShardedEngine.h"
+#include "Replay.h"
+#include "Pipeline.h"
+#include "Sweep.h"
+#include "Checkpoint.h"
+#include "ConfigReloader.h"
+#include "Metrics.h"
 #include <unistd.h>
+#include <sys/stat.h>
 #include <tuple>                                                                
                                                                                 
 #include <boost/property_tree/ptree.hpp>                           
@@ -20,10 +27,6 @@
 using namespace std;
 
 
-//Retain the states per trajectory
-map< long, State* > trajStates;
-map< long, State* >::iterator iterState;
-
 //Retain the user-specified configurations per vessel type
 map< string, Config* > vesselTypeConfigs;    
 
@@ -159,39 +162,26 @@ map< string, Config* > parseConfig(char* configJSONfile) {
 }
 
 
-//Read vessel information from accompanying CSV file
-//IMPORTANT! this identifies vessel type (passenger, cargo, etc.) in order to applys the corresponding configuration settings 
-map< long, string > parseVesselInfo(char* vesselCSVfile) {
-
-    ifstream inFile(vesselCSVfile);
-
-    map< long, string > vesselInfo;
-
-    unsigned int cnt = 0;
-    vector<string> vec;
-
-    if (inFile) {
-        string line;
-        while (getline(inFile, line)) {
-            cnt++;
-            //Skip header
-            if (cnt == 1) 
-                continue;
-
-            // Tokenize the input string using default separator ';'
-            boost::split(vec, line, boost::is_any_of(";"));  //is_any_of("\t ; ,")
-            vesselInfo.insert(pair< long, string >(stoi(vec[0]), vec[2]));
-        }
-    }
-   return vesselInfo;
+//Name of the output file for an alternative configuration in a parameter sweep, e.g., "out.csv" and "settings/angle3.json" give "out_angle3.csv"
+string getSweepOutputName(string outFileName, string configJSONfile)
+{
+    size_t pos = configJSONfile.find_last_of("/\\");
+    string stem = (pos == string::npos) ? configJSONfile : configJSONfile.substr(pos + 1);
+    stem = stem.substr(0, stem.find_last_of('.'));
+
+    size_t dot = outFileName.find_last_of('.');
+    size_t slash = outFileName.find_last_of("/\\");
+    if ((dot == string::npos) || ((slash != string::npos) && (slash > dot)))
+        return outFileName + "_" + stem;
+    return outFileName.substr(0, dot) + "_" + stem + outFileName.substr(dot);
 }
 
 
 //Entry point to the application
 int main(int argc, char* argv[])
 {    
-    if (argc != 8) {
-        cout << "Usage: " << argv[0] << " [input-file] [id-attr] [timestamp-attr] [settings-json] [vessel-info-file] [output-file] [annotated-only]" << endl;
+    if (argc < 8) {
+        cout << "Usage: " << argv[0] << " [input-file] [id-attr] [timestamp-attr] [settings-json] [vessel-info-file] [output-file] [annotated-only] [options]" << endl;
         //EXAMPLE execution command: ./annotate mmsi228037700.csv -1 3 settings.json vessel_info.csv mmsi228037700_annotated.csv true
         //[input-file]: Input data given in file "mmsi228037700.csv" (ASCII space delimited). The contents of the file are used to simulate a positional data stream based on the incoming AIS timestamped locations from vessels.
         //[id-attr]: Specifies the ID attribute in input data; give a negative integer (e.g., -1) if NO vessel identifiers are included in the input data.
@@ -200,9 +190,209 @@ int main(int argc, char* argv[])
         //[vessel-info-file]: Path to CSV file with vessel information (IMPORTANT: includes the type of each vessel in the input data).
         //[output-file]: Output data (points with the detected annotations) will be stored in file "mmsi228037700_annotated.csv" (ASCII space delimited).
         //[annotated-only]: Boolean controlling which points will be emitted. If true, only points with detected annotations will be stored into the output file; otherwise, normal (i.e., not annotated) and noisy points (annotated as NOISE) will be also included.
+        //[options]: Optional arguments (see below).
+        cout << "Options:" << endl;
+        cout << "  --group-by-vessel   Process the tuples of each batch grouped per vessel (in arrival order per vessel)" << endl;
+        cout << "  --threads N         Annotate with N worker threads, each one handling a partition of the vessels (or a time range)" << endl;
+        cout << "  --time-ranges S     Split the input into time ranges of S seconds that are annotated in parallel and stitched together" << endl;
+        cout << "  --warmup S          Overlap (in seconds) for warming up vessel states before each time range (default: 3600)" << endl;
+        cout << "  --partition i/N     Only annotate vessels in partition i (0 <= i < N) by hash of their identifiers; rows are prefixed with ordering keys for merging" << endl;
+        cout << "  --sweep A,B,...     Also annotate with alternative settings from JSON files A, B, ... in the same pass, each one in its own thread and output file" << endl;
+        cout << "  --columnar          Write the output into a binary columnar file (compressed if built with ZSTD=yes); see convert" << endl;
+        cout << "  --synopsis          Append the output to a compact synopsis store [output-file] with blocks per vessel; see extract" << endl;
+        cout << "  --proactive-gaps    Detect gaps (and expunge obsolete locations) as soon as the stream advances past them, instead of upon the next location of each vessel (except for stopped vessels)" << endl;
+        cout << "  --horizon S         Report locations retained for over S seconds of event time (e.g., of long stops or silent vessels), so the output is never held back longer; annotations may then differ from an unbounded run" << endl;
+        cout << "  --pipeline          Read, annotate and write in three pipelined threads, emitting results progressively" << endl;
+        cout << "  --direct-io         Write the output file with O_DIRECT (bypassing the page cache), reserving disk space ahead" << endl;
+        cout << "  --segments          Write trajectory segments between stops and gaps (with their critical points and statistics) instead of locations" << endl;
+        cout << "  --filter-annotations A,B,...  Only write locations with any of the given annotations (e.g., STOP_*,GAP_START)" << endl;
+        cout << "  --filter-bbox X1,Y1,X2,Y2     Only write locations within the given bounding box (lon/lat)" << endl;
+        cout << "  --filter-polygon FILE         Only write locations within the polygon with vertices (lon lat per line) in FILE" << endl;
+        cout << "  --filter-time T1,T2           Only write locations with timestamps between T1 and T2 (inclusive)" << endl;
+        cout << "  --filter-types A,B,...        Only write locations of vessels of the given types (as in [vessel-info-file])" << endl;
+        cout << "  --per-vessel        Write the output of each vessel into a separate file in directory [output-file]" << endl;
+        cout << "  --buckets K         Write the output into K files in directory [output-file], each one with the vessels of a bucket by hash of their identifiers" << endl;
+        cout << "  --writers N         Number of threads writing separate files per vessel or bucket (default: 4)" << endl;
+        cout << "  --max-open F        Maximum number of files kept open by all writers of separate files (default: 256)" << endl;
+        cout << "  --index             Also build a spatio-temporal index of the written locations into file [output-file].idx; see query" << endl;
+        cout << "  --checkpoint FILE   Save a snapshot of vessel states and pending results into FILE at the end of the input, instead of closing all states" << endl;
+        cout << "  --checkpoint-every S  Also save the snapshot every S seconds of event time" << endl;
+        cout << "  --reload-settings   Reload [settings-json] whenever it changes (or on SIGHUP), applying it to each vessel upon its next location" << endl;
+        cout << "  --restore FILE      Resume from the snapshot in FILE: continue the same input and output file where they stopped or, if the input was exhausted, go on with this input" << endl;
+        cout << "  --metrics FILE      Write throughput, latency and memory metrics per batch into FILE (JSON lines), with latency histograms per period" << endl;
+        cout << "  --metrics-every S   Period (in seconds of event time) of latency histograms (default: 3600)" << endl;
+        cout << "  --metrics-format F  Format of the metrics file: json (default) or prometheus (rewritten every period)" << endl;
         exit(0);
     }
 
+    //Optional arguments following the mandatory ones
+    bool groupByVessel = false;      //Dispatch each batch grouped by vessel instead of strictly in arrival order
+    unsigned int numThreads = 1;     //Number of worker threads (shards of vessels or time ranges)
+    unsigned int rangeSpan = 0;      //Span (in seconds) of time ranges annotated in parallel; zero for a single pass over the stream
+    unsigned int warmup = 3600;      //Overlap (in seconds) for warming up states before each time range
+    bool pipelined = false;          //Overlap parsing, annotation and output in separate threads
+    bool proactive = false;          //Expire vessel states by timers as the stream advances
+    unsigned int horizon = 0;        //Locations retained for longer (in seconds of event time) are final; zero if unbounded
+    unsigned int part = 0;           //Partition of vessels handled by this process
+    unsigned int numParts = 0;       //Number of partitions of vessels; zero if all vessels are handled
+    vector<string> sweepJSONfiles;   //Alternative configuration settings to be applied in the same pass
+    OutputFormat format = TEXT_OUTPUT;   //Format of the output file(s)
+    Filter filter;                   //Predicates on the locations written into the output
+    bool filtered = false;           //Whether any filters are specified
+    set<string> filterTypes;         //Vessel types of interest
+    double x1, y1, x2, y2;
+    unsigned int t1, t2;
+    bool directIO = false;           //Write the output file bypassing the page cache
+    unsigned int numBuckets = 0;     //Number of output files by hash of vessel identifiers; zero for a file per vessel
+    unsigned int numWriters = 4;     //Number of threads writing separate output files
+    unsigned int maxOpen = 256;      //Maximum number of separate output files open at any time
+    bool indexed = false;            //Build a spatio-temporal index alongside the output
+    char *checkpointFile = NULL;     //Snapshot of the run saved at the end of the input (and periodically)
+    unsigned int checkpointEvery = 0;    //Period (in seconds of event time) of snapshots; zero if only at the end of the input
+    char *restoreFile = NULL;        //Snapshot of an earlier run to resume from
+    bool reloadSettings = false;     //Reload the configuration settings whenever they change
+    char *metricsFile = NULL;        //Metrics per batch and latency histograms
+    unsigned int metricsEvery = 3600;    //Period (in seconds of event time) of latency histograms
+    MetricsFormat metricsFormat = JSON_METRICS;
+    for (int a = 8; a < argc; a++) {
+        string opt = argv[a];
+        if (opt == "--group-by-vessel")
+            groupByVessel = true;
+        else if ((opt == "--threads") && (a + 1 < argc) && (atoi(argv[a+1]) > 0))
+            numThreads = atoi(argv[++a]);
+        else if ((opt == "--time-ranges") && (a + 1 < argc) && (atoi(argv[a+1]) > 0))
+            rangeSpan = atoi(argv[++a]);
+        else if ((opt == "--warmup") && (a + 1 < argc) && (atoi(argv[a+1]) >= 0))
+            warmup = atoi(argv[++a]);
+        else if (opt == "--pipeline")
+            pipelined = true;
+        else if (opt == "--proactive-gaps")
+            proactive = true;
+        else if ((opt == "--horizon") && (a + 1 < argc) && (atoi(argv[a+1]) >= 0))
+            horizon = atoi(argv[++a]);
+        else if ((opt == "--partition") && (a + 1 < argc) && (sscanf(argv[a+1], "%u/%u", &part, &numParts) == 2) && (part < numParts))
+            a++;
+        else if (opt == "--columnar")
+            format = COLUMNAR_OUTPUT;
+        else if (opt == "--synopsis")
+            format = SYNOPSIS_OUTPUT;
+        else if (opt == "--segments")
+            format = SEGMENT_OUTPUT;
+        else if ((opt == "--filter-annotations") && (a + 1 < argc)) {
+            if (!filter.setAnnotations(argv[++a])) {
+                cout << "Unknown annotation in: " << argv[a] << endl;
+                exit(1);
+            }
+            filtered = true;
+        }
+        else if ((opt == "--filter-bbox") && (a + 1 < argc) && (sscanf(argv[a+1], "%lf,%lf,%lf,%lf", &x1, &y1, &x2, &y2) == 4)) {
+            filter.setBoundingBox(x1, y1, x2, y2);
+            filtered = true;
+            a++;
+        }
+        else if ((opt == "--filter-polygon") && (a + 1 < argc)) {
+            if (!filter.setPolygon(argv[++a])) {
+                cout << "Cannot read a polygon from: " << argv[a] << endl;
+                exit(1);
+            }
+            filtered = true;
+        }
+        else if ((opt == "--filter-time") && (a + 1 < argc) && (sscanf(argv[a+1], "%u,%u", &t1, &t2) == 2)) {
+            filter.setTimeRange(t1, t2);
+            filtered = true;
+            a++;
+        }
+        else if ((opt == "--filter-types") && (a + 1 < argc)) {
+            vector<string> types;
+            boost::split(types, argv[++a], boost::is_any_of(","));
+            filterTypes.insert(types.begin(), types.end());
+            filtered = true;
+        }
+        else if (opt == "--direct-io")
+            directIO = true;
+        else if (opt == "--per-vessel")
+            format = SPLIT_OUTPUT;
+        else if ((opt == "--buckets") && (a + 1 < argc) && (atoi(argv[a+1]) > 0)) {
+            format = SPLIT_OUTPUT;
+            numBuckets = atoi(argv[++a]);
+        }
+        else if ((opt == "--writers") && (a + 1 < argc) && (atoi(argv[a+1]) > 0))
+            numWriters = atoi(argv[++a]);
+        else if ((opt == "--max-open") && (a + 1 < argc) && (atoi(argv[a+1]) > 0))
+            maxOpen = atoi(argv[++a]);
+        else if (opt == "--index")
+            indexed = true;
+        else if ((opt == "--checkpoint") && (a + 1 < argc))
+            checkpointFile = argv[++a];
+        else if ((opt == "--checkpoint-every") && (a + 1 < argc) && (atoi(argv[a+1]) > 0))
+            checkpointEvery = atoi(argv[++a]);
+        else if ((opt == "--restore") && (a + 1 < argc))
+            restoreFile = argv[++a];
+        else if (opt == "--reload-settings")
+            reloadSettings = true;
+        else if ((opt == "--metrics") && (a + 1 < argc))
+            metricsFile = argv[++a];
+        else if ((opt == "--metrics-every") && (a + 1 < argc) && (atoi(argv[a+1]) > 0))
+            metricsEvery = atoi(argv[++a]);
+        else if ((opt == "--metrics-format") && (a + 1 < argc) && ((string(argv[a+1]) == "json") || (string(argv[a+1]) == "prometheus")))
+            metricsFormat = (string(argv[++a]) == "json") ? JSON_METRICS : PROMETHEUS_METRICS;
+        else if ((opt == "--sweep") && (a + 1 < argc))
+            boost::split(sweepJSONfiles, argv[++a], boost::is_any_of(","));
+        else {
+            cout << "Unknown option: " << opt << endl;
+            exit(1);
+        }
+    }
+    if (pipelined && ((numThreads > 1) || (rangeSpan > 0))) {
+        cout << "Option --pipeline cannot be combined with --threads or --time-ranges" << endl;
+        exit(1);
+    }
+    if ((format == COLUMNAR_OUTPUT) && (numParts > 0)) {
+        cout << "Option --columnar cannot be combined with --partition" << endl;
+        exit(1);
+    }
+    if ((format == SPLIT_OUTPUT) && ((atoi(argv[2]) < 1) || ((numBuckets > 0) && (numParts > 0)))) {
+        cout << "Options --per-vessel and --buckets require vessel identifiers; --buckets cannot be combined with --partition" << endl;
+        exit(1);
+    }
+    if ((format == SEGMENT_OUTPUT) && ((numParts > 0) || (rangeSpan > 0) || filtered)) {
+        cout << "Option --segments cannot be combined with --partition, --time-ranges or filters" << endl;
+        exit(1);
+    }
+    if (proactive && ((numThreads > 1) || (rangeSpan > 0) || (numParts > 0))) {
+        cout << "Option --proactive-gaps cannot be combined with --threads, --time-ranges or --partition" << endl;
+        exit(1);
+    }
+    if ((horizon > 0) && (rangeSpan > 0)) {
+        cout << "Option --horizon cannot be combined with --time-ranges" << endl;
+        exit(1);
+    }
+    if (indexed && ((numParts > 0) || (format == SEGMENT_OUTPUT))) {
+        cout << "Option --index cannot be combined with --partition or --segments" << endl;
+        exit(1);
+    }
+    if (!sweepJSONfiles.empty() && ((numThreads > 1) || (rangeSpan > 0) || pipelined)) {
+        cout << "Option --sweep cannot be combined with --threads, --time-ranges or --pipeline" << endl;
+        exit(1);
+    }
+
+    if (((checkpointFile != NULL) || (restoreFile != NULL)) && ((numThreads > 1) || (rangeSpan > 0) || pipelined || !sweepJSONfiles.empty() || (numParts > 0) || (format == SEGMENT_OUTPUT))) {
+        cout << "Options --checkpoint and --restore cannot be combined with --threads, --time-ranges, --pipeline, --sweep, --partition or --segments" << endl;
+        exit(1);
+    }
+    if (reloadSettings && ((numThreads > 1) || (rangeSpan > 0) || pipelined || !sweepJSONfiles.empty())) {
+        cout << "Option --reload-settings cannot be combined with --threads, --time-ranges, --pipeline or --sweep" << endl;
+        exit(1);
+    }
+    if ((metricsFile != NULL) && ((numThreads > 1) || (rangeSpan > 0) || pipelined || !sweepJSONfiles.empty())) {
+        cout << "Option --metrics cannot be combined with --threads, --time-ranges, --pipeline or --sweep" << endl;
+        exit(1);
+    }
+    if ((checkpointEvery > 0) && (checkpointFile == NULL)) {
+        cout << "Option --checkpoint-every requires --checkpoint" << endl;
+        exit(1);
+    }
+
     //First argument defines the input file that contains incoming items
     char *fileName;                
     fileName = argv[1];
@@ -212,6 +402,8 @@ int main(int argc, char* argv[])
 
     //Specifies the timestamp attribute in the schema of input tuples
     scanStream->setTimeAttribute(atoi(argv[3])-1);
+    if (numParts > 0)
+        scanStream->setPartition(part, numParts);
 
     //Parse user-specified configuration settings
     char *configJSONfile;                
@@ -221,8 +413,11 @@ int main(int argc, char* argv[])
     //Associate the vessel types per MMSI from CSV file
     char *vesselInfoCSVfile;                
     vesselInfoCSVfile = argv[5];
-    map< long, string > vesselInfo = parseVesselInfo(vesselInfoCSVfile);
-    string vessel_type = "Default";    
+    //IMPORTANT! this identifies vessel type (passenger, cargo, etc.) in order to apply the corresponding configuration settings
+    VesselRegistry vesselInfo;
+    vesselInfo.load(vesselInfoCSVfile);
+    if (!filterTypes.empty())
+        filter.setVesselTypes(filterTypes, &vesselInfo);
 
     //Check if only annotated points should be emitted to the output file
     std::istringstream flag_anno(argv[7]);
@@ -233,9 +428,32 @@ int main(int argc, char* argv[])
     char *csvCritical;                
     csvCritical = argv[6];
 
+    //A run restored from a snapshot taken before the end of its input (e.g., after a crash) continues the output file as of that snapshot, discarding any rows written after it
+    //Only a text output file can be resumed this way; other outputs (and the index) would lose or duplicate the rows written before the snapshot
+    long resumeAt = -1;
+    if ((restoreFile != NULL) && Checkpoint::resumesOutput(restoreFile, resumeAt)) {
+        struct stat outStat;
+        if ((format != TEXT_OUTPUT) || indexed || (resumeAt < 0)) {
+            cout << "Snapshot file " << restoreFile << " was taken before the end of its input, so it can only resume a text output file; options --columnar, --synopsis, --per-vessel, --buckets and --index cannot be combined with it" << endl;
+            exit(1);
+        }
+        if ((stat(csvCritical, &outStat) != 0) || (outStat.st_size < resumeAt)) {
+            cout << "Output file " << csvCritical << " is shorter than in snapshot " << restoreFile << " (" << resumeAt << " bytes). Please check again." << endl;
+            exit(1);
+        }
+    }
+
     //Prepare a sink to write the results into an output file
     bool includeID = (atoi(argv[2]) >= 1);  // Check if object identifiers should be included in the output; the same ones used in input data
-    Sink * sinkStream = new Sink(csvCritical, includeID);
+    Sink * sinkStream;
+    if (format == SPLIT_OUTPUT)
+        sinkStream = new Sink(new SplitWriter(csvCritical, numBuckets, numWriters, maxOpen));   //Files per vessel need no merging, as each vessel belongs to a single partition
+    else
+        sinkStream = new Sink(csvCritical, includeID, (numParts > 0), format, directIO, resumeAt);   //Output of a partition must be merged with the others afterwards
+    if (filtered)
+        sinkStream->setFilter(&filter);
+    if (indexed)
+        sinkStream->setIndex(new IndexWriter((string(csvCritical) + ".idx").c_str(), includeID));
 
     //The first timestamp value in the input file specifies the time when the window is being applied
     unsigned int t0 = getStartTimestamp(fileName, atoi(argv[3])-1);
@@ -247,96 +465,249 @@ int main(int argc, char* argv[])
     scanStream->curTime = t0;           //Initialization: timestamp value when the window is being applied
 
     vector<Location*> inTuples;         //Batch of incoming tuples
-    vector<Location*>::iterator it;
-
-    map< long, State* >::iterator remIter;
-
-    State *newState;
-    Location *p;
 
     unsigned int t = t0;    //Timestamp values should start from the time given by the window initiation	
-    unsigned int t_proc;    //Measuring execution cost (in milliseconds) per window instantiation
+    unsigned long t_proc;   //Measuring execution cost (in microseconds) per window instantiation
+    unsigned long t_batches = 0;   //Total execution cost (in microseconds) for processing all batches
+    unsigned long t_read, t_flush; //Measuring cost (in microseconds) of reading each batch and writing its final results
 
     unsigned int i = 0;
-    unsigned int k = 0;
+    unsigned int numTuples = 0;    //Number of tuples consumed
+    unsigned int numObjects = 0;   //Number of objects monitored
+
+    vector<Sink *> sweepSinks;     //Output sink per configuration in a parameter sweep (the first one is the output sink)
+    vector<string> sweepOutputs;   //Output files for alternative configurations in a parameter sweep
+
+    //Prepare the metrics file, if requested
+    Metrics *metrics = NULL;
+    vector< pair<long, unsigned int> > pinned;    //Stopped vessels pinning unusually long histories after a batch
+    if (metricsFile != NULL) {
+        Location::startCounting();     //No locations exist yet
+        metrics = new Metrics(metricsFile, metricsFormat, metricsEvery);
+        if (!metrics->good()) {
+            cout << "Cannot write metrics file " << metricsFile << ". Please check again." << endl;
+            exit(1);
+        }
+    }
 
     //Print time indication when evaluation starts
     time_t t_now = time(0);   // get time now
     struct tm * now = localtime( & t_now );
     cout << "Input: " << fileName << " "; // << "\r\n"; 
 
-    //STREAM INPUT: Keep processing data file until it gets exhausted
     unsigned int t_start = get_time();         //Measuring total execution cost (in milliseconds) 
-    while (scanStream->exhausted == false) {
-        //Proceed to accept next batch of tuples up to this timestamp value 
-        t = t + SLIDE;
+    if (rangeSpan > 0) {
+        //ARCHIVE REPLAY: Annotate time ranges of the input in parallel and stitch their states at the boundaries
+        t_proc = get_time_micro();  
+        Replay *replay = new Replay(fileName, atoi(argv[2])-1, scanStream->id, &vesselTypeConfigs, &vesselInfo, sinkStream, rangeSpan, warmup, numThreads, groupByVessel);
+        if (numParts > 0)
+            replay->setPartition(part, numParts);
+        replay->run();
+        t_batches = get_time_micro() - t_proc;
+
+        numTuples = replay->countTuples();
+        numObjects = replay->countStates();
+        cout << "#ranges: " << replay->countRanges() << " #rerun: " << replay->countRerunObjects() << " ";
+        delete replay;
+    }
+    else if (pipelined) {
+        //PIPELINE: Read, annotate and write concurrently; results are emitted as soon as they become final
+        Pipeline *pipeline = new Pipeline(scanStream, t0, &vesselTypeConfigs, &vesselInfo, sinkStream, annotated_only, groupByVessel, proactive, horizon);
+        pipeline->run();
+        t_batches = pipeline->annotator.busy;
+
+        numTuples = scanStream->recCount;
+        numObjects = pipeline->countStates();
+        cout << "Busy/idle per stage (sec): read " << pipeline->reader.busy/1.0e6 << "/" << pipeline->reader.idle/1.0e6
+             << " annotate " << pipeline->annotator.busy/1.0e6 << "/" << pipeline->annotator.idle/1.0e6
+             << " write " << pipeline->writer.busy/1.0e6 << "/" << pipeline->writer.idle/1.0e6 << " ";
+        delete pipeline;
+    }
+    else if (!sweepJSONfiles.empty()) {
+        //PARAMETER SWEEP: The given settings and each alternative one are applied by separate engines over the same parsed tuples
+        vector< map< string, Config* > > sweepConfigs;
+        sweepConfigs.push_back(vesselTypeConfigs);
+        sweepSinks.push_back(sinkStream);
+        for (unsigned int k = 0; k < sweepJSONfiles.size(); k++) {
+            sweepConfigs.push_back(parseConfig((char *)sweepJSONfiles[k].c_str()));
+            sweepOutputs.push_back(getSweepOutputName(csvCritical, sweepJSONfiles[k]));
+            if (format == SPLIT_OUTPUT)
+                sweepSinks.push_back(new Sink(new SplitWriter(sweepOutputs.back().c_str(), numBuckets, numWriters, maxOpen)));
+            else
+                sweepSinks.push_back(new Sink((char *)sweepOutputs.back().c_str(), includeID, (numParts > 0), format, directIO));
+            if (filtered)
+                sweepSinks.back()->setFilter(&filter);
+            if (indexed)
+                sweepSinks.back()->setIndex(new IndexWriter((sweepOutputs.back() + ".idx").c_str(), includeID));
+        }
+        Sweep *sweep = new Sweep(&sweepConfigs, &vesselInfo, sweepSinks, annotated_only, groupByVessel, proactive, horizon);
+
+        //STREAM INPUT: Keep processing data file until it gets exhausted
+        while (scanStream->exhausted == false) {
+            t = t + SLIDE;
+            inTuples = scanStream->consumeInput(t);	
+
+            t_proc = get_time_micro();  
+            sweep->process(inTuples, scanStream->nextTimestamp());
+            t_batches += get_time_micro() - t_proc;
+ 
+            inTuples.clear();
+            i++;
+        }
+
+        //Once the stream is exhausted, all engines expunge their states and emit their results
+        t_proc = get_time_micro();  
+        sweep->close();
+        t_batches += get_time_micro() - t_proc;
+
+        numTuples = scanStream->recCount;
+        numObjects = sweep->countStates();
+        delete sweep;
+    }
+    else {
+        //Annotation engine maintaining the states of all vessels, possibly partitioned among multiple threads
+        ShardedEngine *engine = new ShardedEngine(numThreads, &vesselTypeConfigs, &vesselInfo, sinkStream, groupByVessel, proactive, horizon);
+
+        //RESUME: Restore vessel states, pending results and position in the input from a snapshot of an earlier run
+        if (restoreFile != NULL) {
+            t_proc = get_time_micro();
+            if (!Checkpoint::load(restoreFile, engine->getEngine(0), sinkStream, scanStream, t)) {
+                cout << "Snapshot file " << restoreFile << " not found or corrupt. Please check again." << endl;
+                exit(1);
+            }
+            cout << "Restored: " << restoreFile << " #states: " << engine->countStates() << " Load time (sec): " << (get_time_micro() - t_proc) / 1.0e6 << " ";
+        }
+        unsigned int nextCheckpoint = t + checkpointEvery;   //Event time of the next periodic snapshot
+
+        //HOT RELOAD: Settings are parsed by a watcher thread and picked up between batches
+        ConfigReloader *reloader = NULL;
+        unsigned int settingsVersion = 0;
+        if (reloadSettings) {
+            reloader = new ConfigReloader(configJSONfile, &vesselTypeConfigs, parseConfig);
+            reloader->start();
+        }
+
+        //STREAM INPUT: Keep processing data file until it gets exhausted
+        while (scanStream->exhausted == false) {
+            //Apply settings reloaded since the previous batch to all tuples from now on
+            if ((reloader != NULL) && (reloader->version() != settingsVersion)) {
+                settingsVersion = reloader->version();
+                engine->getEngine(0)->reconfigure(reloader->current());
+                cerr << "Settings reloaded from " << configJSONfile << " (version " << settingsVersion << "): parsed in " << reloader->latency() / 1.0e3
+                     << " ms, applied " << reloader->elapsed() / 1.0e3 << " ms after parsing, in effect for tuples after event time " << t << endl;
+            }
+
+            //Proceed to accept next batch of tuples up to this timestamp value 
+            t = t + SLIDE;
       
-        //Read streaming data
-        inTuples = scanStream->consumeInput(t);	
-
-        //Create new tuples for the current timestamp value
-        t_proc = get_time();  
-        for (it = inTuples.begin(); it != inTuples.end(); it++ ) {
-
-            //UPDATE: Refresh object location and update its state
-            //Get trajectory already maintained for this object
-            iterState = trajStates.find( (*it)->oid );   
-            if (iterState == trajStates.end()) {     //No state available for this object
-                //First, identify the vessel type for this NEW object
-                try { vessel_type = vesselInfo.at((*it)->oid); }
-                catch (const std::out_of_range&) { vessel_type = "Default"; }   //Apply default settings if vessel type is unknown
-                //cout << "Vessel " << (*it)->oid << " type: " << vessel_type << endl;
-
-                //Get configuration settings for this type of vessel            
-                Config* curConfig = (vesselTypeConfigs.find(vessel_type))->second;
-                newState = new State((*it)->oid, (*it)->t, curConfig, sinkStream);
-                newState->init(*it);
-                trajStates.insert(pair< long, State* >((*it)->oid, newState));
-                k = trajStates.size();
+            //Read streaming data
+            t_read = get_time_micro();
+            inTuples = scanStream->consumeInput(t);	
+            t_read = get_time_micro() - t_read;
+
+            //Create new tuples for the current timestamp value
+            t_proc = get_time_micro();  
+
+            //Refresh object locations and update their states
+            engine->process(inTuples, scanStream->nextTimestamp());
+
+            //Processing time for handling ONLINE items (in microseconds)
+            t_proc = get_time_micro() - t_proc;
+            t_batches += t_proc;
+
+            //Low watermark: no location may be reported any more before the oldest one retained in any state or the next incoming tuple
+            //Emit all results up to the watermark in timestamp order and release them; stopped or silent vessels hold it back, unless their locations are final by the horizon
+            t_flush = get_time_micro();
+            sinkStream->flush(min(engine->oldestTimestamp(), scanStream->nextTimestamp()), annotated_only);
+            t_flush = get_time_micro() - t_flush;
+
+            //Measurements of this batch, e.g., to trace a drop in throughput back to the stage and the states responsible for it
+            if (metrics != NULL) {
+                BatchMetrics b = { t, inTuples.size(), t_read, t_proc, t_flush, engine->countStates(), engine->countLocations() };
+                b.memory.batchBytes = inTuples.size() * sizeof(Location) + inTuples.capacity() * sizeof(Location*);
+                engine->measure(b.memory, pinned);
+                metrics->record(b, pinned, sinkStream);
+                pinned.clear();
             }
-            else {
-                //Remove any obsolete locations from the state
-                iterState->second->expungeObsoleteLocations((*it)->t);
-                //Update state with fresh location
-                if (iterState->second->isEmpty()) { //state is empty, possibly because of a communication gap
-                    iterState->second->init(*it);
-                }
-                else {   //Update state and annotate locations accordingly
-                    iterState->second->update(*it);
+
+            //Periodic snapshot, once all results up to the watermark have been emitted
+            if ((checkpointEvery > 0) && (t >= nextCheckpoint) && !scanStream->exhausted) {
+                if (!Checkpoint::save(checkpointFile, engine->getEngine(0), sinkStream, scanStream, t)) {
+                    cout << "Cannot write snapshot file " << checkpointFile << ". Please check again." << endl;
+                    exit(1);
                 }
+                nextCheckpoint = t + checkpointEvery;
             }
+ 
+            inTuples.clear();
+            i++;
         }
 
-        //Processing time for handling ONLINE items (in milliseconds)
-        t_proc = get_time() - t_proc;
- 
-        inTuples.clear();
-        i++;
-    }
+        if (checkpointFile != NULL) {
+            //Keep the states open and save them along with the results not yet final, so that the next run resumes from here
+            t_proc = get_time_micro();
+            if (!Checkpoint::save(checkpointFile, engine->getEngine(0), sinkStream, scanStream, t)) {
+                cout << "Cannot write snapshot file " << checkpointFile << ". Please check again." << endl;
+                exit(1);
+            }
+            sinkStream->clear();
+            cout << "Checkpoint: " << checkpointFile << " (" << Checkpoint::size(checkpointFile) << " bytes) Save time (sec): " << (get_time_micro() - t_proc) / 1.0e6 << " ";
+        }
+        else {
+            //Once the stream is exhausted, expunge any remaining positions from the last state of each sequence
+            t_proc = get_time_micro();  
+            engine->close();
+            t_batches += get_time_micro() - t_proc;
+        }
 
-    //Once the stream is exhausted, expunge any remaining positions from the last state of each sequence
-    for (iterState = trajStates.begin(); iterState != trajStates.end(); iterState++) { 
-        //Mark the last point as GAP_START and report all locations to the output
-        iterState->second->markLastLocationAsGap();    
+        numTuples = scanStream->recCount;
+        numObjects = engine->countStates();
+        delete engine;      //Release states of all objects
+        delete reloader;    //Release reloaded settings, no longer referred to by any states
     }
 
     //Report execution statistics
-    cout << "Output: " << csvCritical << " #objects: " << trajStates.size() << " "; // << "\r\n";  	
+    if (numParts > 0)
+        cout << "Partition: " << part << "/" << numParts << " ";
+    cout << "Output: " << csvCritical << " #objects: " << numObjects << " "; // << "\r\n";  	
     cout << "Runtime (sec): " << (get_time() - t_start)/1000.0f << " "; // << "\r\n"; 
+    cout << "Batch throughput (tuples/sec): " << (unsigned long)(numTuples / (1.0e-6 * max(t_batches, 1UL))) << " "; // << "\r\n"; 
 
-    //Store all collected results into the output file
-    //CAUTION! Done for all locations of all monitored objects once processing is complete
+    //Store all remaining results into the output file
+    //CAUTION! Done for all locations not yet emitted once processing is complete
     sinkStream->emitResults(annotated_only);  // User-specified: include/slip identifiers in the output for MULTIPLE objects and include/skip not annotated points
+    bool complete = sinkStream->close();      //Output is incomplete if any rows could not be written
 
-    //Report compression ratio
-    cout << "Compression ratio: " << (scanStream->recCount - sinkStream->countAnnotatedLocations())/(1.0f * scanStream->recCount) << "\r\n";
+    //Latest metrics, once all results have been written
+    if (metrics != NULL) {
+        metrics->close(sinkStream);
+        delete metrics;
+    }
+
+    //Report compression ratio; none for an empty input (e.g., a partition without any vessels)
+    cout << "Compression ratio: " << ((numTuples > 0) ? (numTuples - sinkStream->countAnnotatedLocations())/(1.0f * numTuples) : 0.0f) << "\r\n";
+
+    //Summary of a parameter sweep: compression ratio per configuration
+    if (!sweepSinks.empty()) {
+        cout << left << setw(32) << "settings" << setw(40) << "output" << right << setw(12) << "#annotated" << setw(12) << "#noise" << setw(14) << "compression" << endl;
+        for (unsigned int k = 0; k < sweepSinks.size(); k++) {
+            cout << left << setw(32) << ((k == 0) ? configJSONfile : sweepJSONfiles[k-1]) << setw(40) << ((k == 0) ? csvCritical : sweepOutputs[k-1]) << right
+                 << setw(12) << sweepSinks[k]->countAnnotatedLocations() << setw(12) << sweepSinks[k]->countNoisyLocations()
+                 << setw(14) << setprecision(6) << fixed << ((numTuples > 0) ? (numTuples - sweepSinks[k]->countAnnotatedLocations())/(1.0f * numTuples) : 0.0f) << endl;
+            if (k > 0) {
+                complete = sweepSinks[k]->close() && complete;
+                delete sweepSinks[k];
+            }
+        }
+    }
 
     delete scanStream;	//Release scan operator
     delete sinkStream;  //Release sink operator with output results
 
-    //Release states of all objects
-    for (iterState = trajStates.begin(); iterState != trajStates.end(); iterState++ )
-        delete iterState->second;
+    if (!complete) {
+        cout << "Output is incomplete, as some rows could not be written. Please check again." << endl;
+        return 1;
+    }
 
     return 0;
 }
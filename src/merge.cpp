@@ -0,0 +1,152 @@
+//Title: merge.cpp
+//Description: Merge the outputs of partitioned runs (option --partition i/N) into a single output file, identical to that of a run over the entire input with the same options.
+//             Each partition is already ordered by timestamp and then by the trigger of each report (first column); since reports with the same trigger always concern
+//             the same vessel, a k-way merge on these keys that keeps the order of rows within each partition restores the order of a single run.
+//CAUTION: All partitions must have been produced from the same input file and with the same settings and options (except for the partition).
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+
+#include "mobility.h"
+
+
+//Next row available from a partition
+struct PartRow {
+    unsigned int t;            //Timestamp of the row
+    unsigned long trigger;     //Trigger of the report
+    unsigned int part;         //Partition of this row
+    string line;               //Contents of the row, without the trigger
+
+    //Reverse order, so that the row with the smallest keys is on top of a priority queue
+    bool operator<(const PartRow &r) const {
+        if (t != r.t)
+            return (t > r.t);
+        if (trigger != r.trigger)
+            return (trigger > r.trigger);
+        return (part > r.part);
+    }
+};
+
+
+//Read the next row from a partition; false once it gets exhausted
+//A malformed row (e.g., truncated by a partition run that was killed) or an empty line before the end of the file is reported, and the merge fails
+bool readRow(ifstream &in, const char *fileName, unsigned int part, unsigned int colTime, PartRow &row)
+{
+    string sLine;
+    if (!getline(in, sLine))
+        return false;
+    if ((sLine.empty() || (sLine == "\r")) && (in.peek() == EOF))
+        return false;
+
+    //First column is the trigger; keep the rest of the row intact
+    size_t pos = sLine.find(DELIMITER);
+    char *end = NULL;
+    bool valid = (pos != string::npos) && (pos > 0);
+    if (valid) {
+        row.trigger = strtoul(sLine.c_str(), &end, 10);
+        valid = (end == sLine.c_str() + pos);
+    }
+    row.line = valid ? sLine.substr(pos + 1) : "";
+    row.part = part;
+
+    //Locate the timestamp attribute in the remaining row
+    const char *c = row.line.c_str();
+    for (unsigned int k = 0; valid && (k < colTime); k++) {
+        c = strchr(c, DELIMITER);
+        valid = (c != NULL);
+        if (valid)
+            c++;
+    }
+    if (valid) {
+        row.t = strtoul(c, &end, 10);
+        valid = (end != c) && ((*end == DELIMITER) || (*end == '\0') || (*end == '\r'));
+    }
+
+    if (!valid) {
+        cout << "Partition file " << fileName << " has a malformed row: \"" << sLine << "\". Please check again." << endl;
+        exit(1);
+    }
+    return true;
+}
+
+
+//Entry point to the merge tool
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " [output-file] [partition-file-1] ... [partition-file-N]" << endl;
+        //EXAMPLE execution command: ./merge vessels_annotated.csv part0.csv part1.csv part2.csv
+        //[output-file]: Merged output data, as emitted by a single run over the entire input.
+        //[partition-file-i]: Output of the run with option --partition i/N.
+        exit(0);
+    }
+
+    unsigned int numParts = argc - 2;
+    vector<ifstream *> parts;
+    string header;
+    unsigned int colTime = 0;
+
+    for (unsigned int i = 0; i < numParts; i++) {
+        ifstream *in = new ifstream(argv[i + 2]);
+        string sLine;
+        if (!in->good() || !getline(*in, sLine) || (sLine.compare(0, 8, "trigger ") != 0)) {
+            cout << "Partition file " << argv[i + 2] << " not found or not produced with option --partition. Please check again." << endl;
+            exit(1);
+        }
+
+        //Column names without the trigger; the same in all partitions
+        sLine = sLine.substr(8);
+        if (i == 0) {
+            header = sLine;
+            string tok;
+            stringstream ss(sLine);
+            while (getline(ss, tok, DELIMITER) && (tok != "t"))
+                colTime++;
+        }
+        else if (sLine != header) {
+            cout << "Partition file " << argv[i + 2] << " has different attributes than " << argv[2] << "." << endl;
+            exit(1);
+        }
+        parts.push_back(in);
+    }
+
+    ofstream fout(argv[1]);
+    if (!fout.good()) {
+        cout << "Cannot write output file " << argv[1] << ". Please check again." << endl;
+        exit(1);
+    }
+    fout << header << "\n";
+
+    //K-way merge of the partitions
+    priority_queue<PartRow> heads;
+    PartRow row;
+    for (unsigned int i = 0; i < numParts; i++)
+        if (readRow(*parts[i], argv[i + 2], i, colTime, row))
+            heads.push(row);
+
+    unsigned long numRows = 0;
+    while (!heads.empty()) {
+        row = heads.top();
+        heads.pop();
+        fout << row.line << "\n";     //Rows retain their line terminator
+        numRows++;
+
+        if (readRow(*parts[row.part], argv[row.part + 2], row.part, colTime, row))
+            heads.push(row);
+    }
+
+    for (unsigned int i = 0; i < numParts; i++) {
+        parts[i]->close();
+        delete parts[i];
+    }
+    fout.close();
+    if (!fout.good()) {
+        cout << "Failed writing output file " << argv[1] << ". Output is incomplete, please check again." << endl;
+        exit(1);
+    }
+
+    cout << "Output: " << argv[1] << " #partitions: " << numParts << " #rows: " << numRows << endl;
+
+    return 0;
+}
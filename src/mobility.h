@@ -17,8 +17,12 @@
 #include <sstream>
 #include <cmath>
 #include <map>
+#include <set>
+#include <unordered_set>
 #include <algorithm>
 #include <numeric>
+#include <climits>
+#include <limits>
 #include <chrono>
 #include <valarray>
 
@@ -42,6 +46,13 @@ inline unsigned int get_time()
     return (unsigned int)millis;
 }
 
+//Get system time in microseconds
+inline unsigned long get_time_micro() 
+{
+    std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+}
+
 //Remain idle for the specified time interval
 inline void sleepTime(clock_t sec) 
 {
@@ -239,4 +250,57 @@ inline double getRateOfTurn(Location *p_old, Location *p_new)
     else
         return (phi / (1.0f * p_new->time_elapsed));
 }
-	
\ No newline at end of file
+
+
+//Assign an object to one of n partitions by hashing its identifier (Fibonacci hashing spreads consecutive identifiers evenly)
+inline unsigned int hashObject(long oid, unsigned int n)
+{
+    return (unsigned int)((((unsigned long)oid * 0x9E3779B97F4A7C15UL) >> 32) % n);
+}
+
+
+//Assign an object to one of n partitions of the input processed by separate processes (e.g., on different nodes)
+//Uses a different hash than hashObject(), so that the shards of threads within each process remain balanced; results are identical on any platform
+inline unsigned int partitionObject(long oid, unsigned int n)
+{
+    unsigned long h = (unsigned long)oid * 0xC2B2AE3D27D4EB4FUL;
+    return (unsigned int)((h ^ (h >> 29)) >> 32) % n;
+}
+
+
+//Stable partitioning of a batch of locations by object identifier (LSD radix sort on 8-bit digits of the identifier)
+//The order of locations per object is preserved, so each object still receives its locations in arrival order
+inline void groupByObject(vector<Location*> &batch, vector<Location*> &buffer)
+{
+    size_t n = batch.size();
+    if (n < 2)
+        return;
+
+    //Histograms for all digits collected in a single pass over the batch
+    size_t counts[8][256];
+    memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < n; i++) {
+        unsigned long key = (unsigned long)batch[i]->oid;
+        for (unsigned int d = 0; d < 8; d++)
+            counts[d][(key >> (8 * d)) & 0xFF]++;
+    }
+
+    buffer.resize(n);
+    for (unsigned int d = 0; d < 8; d++) {
+        //Skip digits shared by all identifiers (e.g., the upper bytes of MMSI numbers)
+        if (counts[d][((unsigned long)batch[0]->oid >> (8 * d)) & 0xFF] == n)
+            continue;
+
+        size_t offsets[256];
+        size_t sum = 0;
+        for (unsigned int b = 0; b < 256; b++) {
+            offsets[b] = sum;
+            sum += counts[d][b];
+        }
+
+        //Scatter into the buffer in a stable manner and swap roles
+        for (size_t i = 0; i < n; i++)
+            buffer[offsets[((unsigned long)batch[i]->oid >> (8 * d)) & 0xFF]++] = batch[i];
+        batch.swap(buffer);
+    }
+}
@@ -0,0 +1,88 @@
+//Title: query.cpp
+//Description: Range queries over the spatio-temporal index built alongside the output (option --index), e.g., all STOP_START locations within a bounding box over a week.
+//             Qualifying locations are written in the space delimited text format, identical to their rows in the output and in the same order.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+
+#include "SpatialIndex.h"
+#include "Formatter.h"
+#include "Filter.h"
+#include "mobility.h"
+#include <cfloat>
+
+
+//Entry point to the query tool
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " [index-file] [output-file] [options]" << endl;
+        //EXAMPLE execution command: ./query vessels_annotated.csv.idx stops.csv --bbox 23.5,37.8,23.7,38.0 --time 1443650400,1444255200 --annotations STOP_START
+        //[index-file]: Index built by annotate with option --index.
+        //[output-file]: Qualifying locations in text format (ASCII space delimited).
+        cout << "Options:" << endl;
+        cout << "  --bbox X1,Y1,X2,Y2     Only locations within the given bounding box (lon/lat, inclusive)" << endl;
+        cout << "  --time T1,T2           Only locations with timestamps between T1 and T2 (inclusive)" << endl;
+        cout << "  --annotations A,B,...  Only locations with any of the given annotations (e.g., STOP_*,GAP_START)" << endl;
+        exit(0);
+    }
+
+    double x1 = -DBL_MAX, y1 = -DBL_MAX, x2 = DBL_MAX, y2 = DBL_MAX;
+    unsigned int t1 = 0, t2 = UINT_MAX;
+    Filter annotations;        //Only used for resolving annotation names into bits
+    for (int a = 3; a < argc; a++) {
+        string opt = argv[a];
+        if ((opt == "--bbox") && (a + 1 < argc) && (sscanf(argv[a+1], "%lf,%lf,%lf,%lf", &x1, &y1, &x2, &y2) == 4))
+            a++;
+        else if ((opt == "--time") && (a + 1 < argc) && (sscanf(argv[a+1], "%u,%u", &t1, &t2) == 2))
+            a++;
+        else if ((opt == "--annotations") && (a + 1 < argc)) {
+            if (!annotations.setAnnotations(argv[++a])) {
+                cout << "Unknown annotation in: " << argv[a] << endl;
+                exit(1);
+            }
+        }
+        else {
+            cout << "Unknown option: " << opt << endl;
+            exit(1);
+        }
+    }
+
+    unsigned long t_start = get_time_micro();
+    IndexReader *reader = new IndexReader(argv[1]);
+    if (!reader->good()) {
+        cout << "Index file " << argv[1] << " not found or corrupt. Please check again." << endl;
+        exit(1);
+    }
+
+    unsigned long t_query = get_time_micro();
+    vector<const IndexRecord*> results;
+    reader->query(x1, y1, x2, y2, t1, t2, annotations.getAnnotationMask(), results);
+    t_query = get_time_micro() - t_query;
+
+    ofstream fout(argv[2]);
+    Formatter *formatter = new Formatter(reader->includesId(), false);
+    formatter->setOutput(&fout);
+    formatter->writeHeader();
+    Location p;
+    for (size_t i = 0; i < results.size(); i++) {
+        p.oid = results[i]->oid;
+        p.x = results[i]->x;
+        p.y = results[i]->y;
+        p.t = results[i]->t;
+        p.speed = results[i]->speed;
+        p.heading = results[i]->heading;
+        p.annotation = bitset<11>(results[i]->annotation);
+        formatter->writeRow(&p, 0);
+    }
+    delete formatter;
+    fout.close();
+
+    cout << "Index: " << argv[1] << " #indexed: " << reader->countRecords() << " #results: " << results.size() << " ";
+    cout << "Query time (ms): " << t_query / 1.0e3 << " Runtime (sec): " << (get_time_micro() - t_start) / 1.0e6 << endl;
+
+    delete reader;
+
+    return 0;
+}
@@ -0,0 +1,457 @@
+//Title: regress.cpp
+//Description: End-to-end regression harness: run annotate over the cases listed in a file (sample inputs or synthetic workloads), verify each output against a reference output or a golden hash,
+//             and append wall time, throughput, peak RSS and compression ratio per case into a results file; optionally compare them against the results of an earlier (baseline) run.
+//             Each case is run in a child process, so that its peak RSS is measured separately (as reported by wait4).
+//             A case may also run annotate over successive parts of its input, resuming each one from a snapshot of the previous one, or over partitions of vessels merged afterwards.
+//Tested on platform(s): gcc 12.2.0
+//Date: 18/10/2026
+//Revision: 18/10/2026
+
+
+#include "mobility.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#define FNV_OFFSET 0xcbf29ce484222325UL
+#define FNV_PRIME 0x100000001b3UL
+
+
+//Case of the harness, as listed in the cases file: arguments of annotate along with the expected output
+struct Case {
+    string name;
+    string input;              //Input file, or gen:VESSELS:DURATION:SEED for a synthetic workload
+    string idAttr;
+    string timeAttr;
+    string settings;
+    string vesselInfo;
+    string annotatedOnly;
+    string expected;           //Reference output, fnv1a:HASH of the output, or - if not verified
+    vector<string> options;
+    unsigned int numSplits;    //Parts of the input annotated in successive runs, each one restored from a snapshot of the previous one (+split N); 1 if the input is annotated at once
+    unsigned int numPartitions;    //Partitions of vessels annotated separately and merged afterwards (+partitions N); 0 if none
+};
+
+
+//Measurements of a case, as recorded in the results file
+struct Result {
+    string status;             //OK, DIFF (output differs from the expected one), or FAIL (annotate failed)
+    double wallTime;           //Seconds (best of all repeats)
+    long peakRSS;              //Kilobytes (highest of all repeats)
+    double throughput;         //Tuples per second, as reported by annotate
+    double compression;        //Compression ratio, as reported by annotate
+    string hash;               //Hash of the output
+};
+
+
+//Directory of the given path (with a trailing slash), or empty if none
+string getDirectory(const string &path)
+{
+    size_t pos = path.rfind('/');
+    return (pos == string::npos) ? "" : path.substr(0, pos + 1);
+}
+
+
+//Check whether a file exists
+bool fileExists(const string &path)
+{
+    struct stat st;
+    return (stat(path.c_str(), &st) == 0);
+}
+
+
+//64-bit FNV-1a hash of the contents of a file, as "fnv1a:" followed by 16 hexadecimal digits; empty if the file cannot be read
+string hashFile(const string &path)
+{
+    ifstream in(path.c_str(), ios::in | ios::binary);
+    if (!in.good())
+        return "";
+    vector<char> buf(OUTPUT_BUFFER_SIZE);
+    unsigned long h = FNV_OFFSET;
+    while (in.read(&buf[0], buf.size()) || (in.gcount() > 0)) {
+        size_t n = in.gcount();
+        for (size_t i = 0; i < n; i++)
+            h = (h ^ (unsigned char)buf[i]) * FNV_PRIME;
+    }
+    char s[32];
+    snprintf(s, sizeof(s), "fnv1a:%016lx", h);
+    return string(s);
+}
+
+
+//Check whether two files have identical contents
+bool sameFiles(const string &path1, const string &path2)
+{
+    ifstream in1(path1.c_str(), ios::in | ios::binary), in2(path2.c_str(), ios::in | ios::binary);
+    if (!in1.good() || !in2.good())
+        return false;
+    vector<char> buf1(OUTPUT_BUFFER_SIZE), buf2(OUTPUT_BUFFER_SIZE);
+    while (true) {
+        in1.read(&buf1[0], buf1.size());
+        in2.read(&buf2[0], buf2.size());
+        if ((in1.gcount() != in2.gcount()) || (memcmp(&buf1[0], &buf2[0], in1.gcount()) != 0))
+            return false;
+        if (in1.gcount() == 0)
+            return true;
+    }
+}
+
+
+//Run a program with the given arguments in a child process, with its standard output and error redirected into a log file
+//Returns its exit status (-1 if it could not be run), along with its wall time (in seconds) and peak RSS (in kilobytes)
+int runProcess(const vector<string> &args, const string &logFile, double &wallTime, long &peakRSS)
+{
+    vector<char *> argv;
+    for (size_t i = 0; i < args.size(); i++)
+        argv.push_back((char *)args[i].c_str());
+    argv.push_back(NULL);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0)
+        return -1;
+    if (pid == 0) {
+        int fd = open(logFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+        execv(argv[0], &argv[0]);
+        _exit(127);
+    }
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) < 0)
+        return -1;
+    wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    peakRSS = usage.ru_maxrss;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+
+//Value following the given label in a log (e.g., "Compression ratio: "); zero if missing
+double getLogValue(const string &logFile, const string &label)
+{
+    ifstream in(logFile.c_str());
+    string contents((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    size_t pos = contents.rfind(label);
+    return (pos == string::npos) ? 0.0 : atof(contents.c_str() + pos + label.size());
+}
+
+
+//Parse the cases file; paths of inputs, settings and reference outputs are relative to its directory
+vector<Case> parseCases(const string &casesFile)
+{
+    vector<Case> cases;
+    string dir = getDirectory(casesFile);
+    ifstream in(casesFile.c_str());
+    string sLine;
+    while (getline(in, sLine)) {
+        if (sLine.empty() || (sLine[0] == '#'))
+            continue;
+        stringstream ss(sLine);
+        Case c;
+        if (!(ss >> c.name >> c.input >> c.idAttr >> c.timeAttr >> c.settings >> c.vesselInfo >> c.annotatedOnly >> c.expected))
+            continue;
+        //Options starting with + are directives of the harness rather than options of annotate
+        string opt;
+        c.numSplits = 1;
+        c.numPartitions = 0;
+        while (ss >> opt) {
+            if (opt == "+split")
+                ss >> c.numSplits;
+            else if (opt == "+partitions")
+                ss >> c.numPartitions;
+            else if (opt[0] == '+')
+                cout << "Unknown directive " << opt << " in case " << c.name << " is ignored." << endl;
+            else
+                c.options.push_back(opt);
+        }
+        c.numSplits = max(c.numSplits, 1U);
+        if (c.input.compare(0, 4, "gen:") != 0)
+            c.input = dir + c.input;
+        c.settings = dir + c.settings;
+        c.vesselInfo = dir + c.vesselInfo;
+        if ((c.expected != "-") && (c.expected.compare(0, 6, "fnv1a:") != 0))
+            c.expected = dir + c.expected;
+        cases.push_back(c);
+    }
+    return cases;
+}
+
+
+//Generate the synthetic workload of a case into the work directory (unless already there), along with its vessel information; false if generation failed
+//Since the generator is deterministic, a workload generated by an earlier run is reused
+bool generateInput(Case &c, const string &binDir, const string &workDir)
+{
+    unsigned long vessels, duration, seed;
+    if (sscanf(c.input.c_str(), "gen:%lu:%lu:%lu", &vessels, &duration, &seed) != 3)
+        return false;
+    string base = workDir + "/gen_" + to_string(vessels) + "_" + to_string(duration) + "_" + to_string(seed);
+    string input = base + ".csv";
+    string registry = base + "_vessels.csv";
+    if (!fileExists(input) || !fileExists(registry)) {
+        vector<string> args = { binDir + "/generate", c.vesselInfo, input + ".tmp", to_string(vessels), to_string(duration), "--seed", to_string(seed), "--registry", registry };
+        double wallTime;
+        long peakRSS;
+        cout << "Generating " << input << " ..." << endl;
+        if ((runProcess(args, base + ".log", wallTime, peakRSS) != 0) || (rename((input + ".tmp").c_str(), input.c_str()) != 0))
+            return false;
+    }
+    c.input = input;
+    c.vesselInfo = registry;
+    return true;
+}
+
+
+//Split an input file into the given number of parts with about as many rows each, named after the given prefix; false if it cannot be read or written
+bool splitInput(const string &input, unsigned int numParts, const string &prefix, vector<string> &parts)
+{
+    ifstream in(input.c_str());
+    if (!in.good())
+        return false;
+    unsigned long numRows = count(istreambuf_iterator<char>(in), istreambuf_iterator<char>(), '\n');
+    in.clear();
+    in.seekg(0);
+
+    string sLine;
+    for (unsigned int k = 0; k < numParts; k++) {
+        parts.push_back(prefix + to_string(k) + ".csv");
+        ofstream out(parts.back().c_str(), ios::out | ios::trunc);
+        for (unsigned long i = numRows * k / numParts; (i < numRows * (k + 1) / numParts) && getline(in, sLine); i++)
+            out << sLine << '\n';
+        if (!out.good())
+            return false;
+    }
+    return true;
+}
+
+
+//Append the rows of a file after its header into another one; false if either file cannot be read or written
+bool appendRows(const string &path, ofstream &out)
+{
+    ifstream in(path.c_str(), ios::in | ios::binary);
+    string sLine;
+    if (!in.good() || !getline(in, sLine))
+        return false;
+    out << in.rdbuf();
+    return out.good();
+}
+
+
+//Run a case the given number of times, verify its output and collect its measurements
+//The wall time of a case with several runs of annotate (over parts of its input or partitions of vessels) is their total, including the merge of partitions
+Result runCase(Case &c, const string &binDir, const string &workDir, unsigned int repeats, bool keep)
+{
+    Result r = { "FAIL", 0.0, 0, 0.0, 0.0, "" };
+    if ((c.input.compare(0, 4, "gen:") == 0) && !generateInput(c, binDir, workDir))
+        return r;
+
+    string output = workDir + "/" + c.name + ".out";
+    string logFile = workDir + "/" + c.name + ".log";
+    string snapshot = workDir + "/" + c.name + ".snap";
+    vector<string> inputs;
+    if (c.numSplits == 1)
+        inputs.push_back(c.input);
+    else if (!splitInput(c.input, c.numSplits, workDir + "/" + c.name + ".in", inputs))
+        return r;
+
+    //Successive runs over the parts of the input, each one restored from the snapshot of the previous one; or a run per partition of vessels, followed by their merge
+    vector< vector<string> > runs;
+    vector<string> outputs;
+    for (unsigned int k = 0; k < max(c.numPartitions, 1U); k++) {
+        for (size_t i = 0; i < inputs.size(); i++) {
+            outputs.push_back((runs.empty() && (inputs.size() == 1) && (c.numPartitions == 0)) ? output : output + "." + to_string(runs.size()));
+            vector<string> args = { binDir + "/annotate", inputs[i], c.idAttr, c.timeAttr, c.settings, c.vesselInfo, outputs.back(), c.annotatedOnly };
+            args.insert(args.end(), c.options.begin(), c.options.end());
+            if (c.numPartitions > 0)
+                args.insert(args.end(), { "--partition", to_string(k) + "/" + to_string(c.numPartitions) });
+            if (i + 1 < inputs.size())
+                args.insert(args.end(), { "--checkpoint", snapshot });
+            if (i > 0)
+                args.insert(args.end(), { "--restore", snapshot });
+            runs.push_back(args);
+        }
+    }
+    if (c.numPartitions > 0) {
+        vector<string> args = { binDir + "/merge", output };
+        args.insert(args.end(), outputs.begin(), outputs.end());
+        runs.push_back(args);
+    }
+
+    //Throughput and compression ratio are taken from the log of the last run of annotate
+    size_t last = runs.size() - ((c.numPartitions > 0) ? 2 : 1);
+    for (unsigned int k = 0; k < repeats; k++) {
+        double wallTime = 0.0;
+        long peakRSS = 0;
+        for (size_t i = 0; i < runs.size(); i++) {
+            double t;
+            long rss;
+            if (runProcess(runs[i], (i == last) ? logFile : logFile + "." + to_string(i), t, rss) != 0)
+                return r;
+            wallTime += t;
+            peakRSS = max(peakRSS, rss);
+        }
+        if ((k == 0) || (wallTime < r.wallTime))
+            r.wallTime = wallTime;
+        r.peakRSS = max(r.peakRSS, peakRSS);
+    }
+
+    //Outputs of successive runs (without their headers) make up the output of a single run
+    if ((inputs.size() > 1) && (c.numPartitions == 0)) {
+        ofstream out(output.c_str(), ios::out | ios::binary | ios::trunc);
+        for (size_t i = 0; i < outputs.size(); i++) {
+            if (i == 0) {
+                ifstream in(outputs[i].c_str(), ios::in | ios::binary);
+                out << in.rdbuf();
+            }
+            else if (!appendRows(outputs[i], out))
+                return r;
+        }
+    }
+    r.throughput = getLogValue(logFile, "Batch throughput (tuples/sec): ");
+    r.compression = getLogValue(logFile, "Compression ratio: ");
+    r.hash = hashFile(output);
+
+    if (c.expected == "-")
+        r.status = "OK";
+    else if (c.expected.compare(0, 6, "fnv1a:") == 0)
+        r.status = (r.hash == c.expected) ? "OK" : "DIFF";
+    else
+        r.status = sameFiles(output, c.expected) ? "OK" : "DIFF";
+
+    if (!keep) {
+        remove(output.c_str());
+        remove(snapshot.c_str());
+        for (size_t i = 0; i < outputs.size(); i++)
+            remove(outputs[i].c_str());
+        for (size_t i = 0; (inputs.size() > 1) && (i < inputs.size()); i++)
+            remove(inputs[i].c_str());
+    }
+    return r;
+}
+
+
+//Latest results per case in a results file (JSON lines written by this harness)
+map< string, Result > loadBaseline(const string &resultsFile)
+{
+    map< string, Result > baseline;
+    ifstream in(resultsFile.c_str());
+    string sLine;
+    while (getline(in, sLine)) {
+        char name[256], status[16], hash[64];
+        Result r;
+        if (sscanf(sLine.c_str(), "{\"case\":\"%255[^\"]\",\"status\":\"%15[^\"]\",\"wall_sec\":%lf,\"peak_rss_kb\":%ld,\"throughput\":%lf,\"compression\":%lf,\"hash\":\"%63[^\"]\"",
+                   name, status, &r.wallTime, &r.peakRSS, &r.throughput, &r.compression, hash) == 7) {
+            r.status = status;
+            r.hash = hash;
+            baseline[name] = r;
+        }
+    }
+    return baseline;
+}
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " [cases-file] [results-file] [options]" << endl;
+        //EXAMPLE execution command: ./regress ../test/regress.cases results.jsonl --baseline baseline.jsonl
+        //[cases-file]: Cases to run, one per line: name input id-attr timestamp-attr settings vessel-info annotated-only expected [options of annotate]
+        //[results-file]: Measurements of each case are appended into this file as JSON lines.
+        cout << "Options:" << endl;
+        cout << "  --baseline FILE     Compare against the latest results per case in FILE (from an earlier run); regressions fail the harness" << endl;
+        cout << "  --tolerance P       Relative increase in wall time or peak RSS over the baseline that counts as a regression (default: 0.1)" << endl;
+        cout << "  --repeats N         Run each case N times, keeping the best wall time (default: 1)" << endl;
+        cout << "  --bin DIR           Directory with the annotate and generate binaries (default: .)" << endl;
+        cout << "  --work DIR          Directory for outputs and generated workloads, created if missing (default: regress.work in the temporary directory, i.e., $TMPDIR or /tmp)" << endl;
+        cout << "  --keep              Keep the outputs of all cases in the work directory" << endl;
+        exit(0);
+    }
+
+    string baselineFile;
+    double tolerance = 0.1;
+    unsigned int repeats = 1;
+    string binDir = ".";
+    string workDir = string((getenv("TMPDIR") != NULL) ? getenv("TMPDIR") : "/tmp") + "/regress.work";     //Outside the source tree
+    bool keep = false;
+    for (int a = 3; a < argc; a++) {
+        string opt = argv[a];
+        if ((opt == "--baseline") && (a + 1 < argc))
+            baselineFile = argv[++a];
+        else if ((opt == "--tolerance") && (a + 1 < argc) && (atof(argv[a+1]) >= 0.0))
+            tolerance = atof(argv[++a]);
+        else if ((opt == "--repeats") && (a + 1 < argc) && (atoi(argv[a+1]) > 0))
+            repeats = atoi(argv[++a]);
+        else if ((opt == "--bin") && (a + 1 < argc))
+            binDir = argv[++a];
+        else if ((opt == "--work") && (a + 1 < argc))
+            workDir = argv[++a];
+        else if (opt == "--keep")
+            keep = true;
+        else {
+            cout << "Unknown option: " << opt << endl;
+            exit(1);
+        }
+    }
+
+    vector<Case> cases = parseCases(argv[1]);
+    if (cases.empty()) {
+        cout << "No cases found in " << argv[1] << ". Please check again." << endl;
+        exit(1);
+    }
+    map< string, Result > baseline;
+    if (!baselineFile.empty()) {
+        baseline = loadBaseline(baselineFile);
+        if (baseline.empty()) {
+            cout << "No results found in baseline file " << baselineFile << ". Please check again." << endl;
+            exit(1);
+        }
+    }
+    mkdir(workDir.c_str(), 0755);
+    ofstream results(argv[2], ios::out | ios::app);
+
+    cout << left << setw(24) << "case" << setw(8) << "status" << right << setw(12) << "wall (sec)" << setw(14) << "peak RSS (MB)"
+         << setw(14) << "tuples/sec" << setw(13) << "compression" << "  baseline" << endl;
+    unsigned int numFailed = 0, numRegressed = 0;
+    for (size_t i = 0; i < cases.size(); i++) {
+        Result r = runCase(cases[i], binDir, workDir, repeats, keep);
+        if (r.status != "OK")
+            numFailed++;
+
+        results << "{\"case\":\"" << cases[i].name << "\",\"status\":\"" << r.status << "\",\"wall_sec\":" << setprecision(3) << fixed << r.wallTime
+                << ",\"peak_rss_kb\":" << r.peakRSS << ",\"throughput\":" << setprecision(0) << r.throughput << ",\"compression\":" << setprecision(6) << r.compression
+                << ",\"hash\":\"" << r.hash << "\",\"repeats\":" << repeats << ",\"time\":" << time(0) << "}" << endl;
+
+        cout << left << setw(24) << cases[i].name << setw(8) << r.status << right << setw(12) << setprecision(3) << fixed << r.wallTime
+             << setw(14) << setprecision(1) << r.peakRSS / 1024.0 << setw(14) << setprecision(0) << r.throughput << setw(13) << setprecision(6) << r.compression;
+
+        //Regressions w.r.t. the baseline: slower (beyond the tolerance, and by more than the resolution of short runs), more memory, or a different output
+        map< string, Result >::iterator it = baseline.find(cases[i].name);
+        if (it != baseline.end()) {
+            const Result &b = it->second;
+            string flags;
+            if ((r.wallTime > b.wallTime * (1.0 + tolerance)) && (r.wallTime - b.wallTime > 0.05))
+                flags += " SLOWER";
+            if (r.peakRSS > b.peakRSS * (1.0 + tolerance))
+                flags += " MORE-MEMORY";
+            if ((r.status == "OK") && !b.hash.empty() && (r.hash != b.hash))
+                flags += " OUTPUT-CHANGED";
+            if (!flags.empty())
+                numRegressed++;
+            cout << setprecision(1) << "  " << showpos << 100.0 * (r.wallTime / max(b.wallTime, 1.0e-3) - 1.0) << "% time " << 100.0 * ((double)r.peakRSS / max(b.peakRSS, 1L) - 1.0) << "% RSS" << noshowpos << flags;
+        }
+        cout << endl;
+    }
+
+    cout << cases.size() << " cases: " << (cases.size() - numFailed) << " passed, " << numFailed << " failed";
+    if (!baseline.empty())
+        cout << ", " << numRegressed << " regressed w.r.t. " << baselineFile;
+    cout << endl;
+
+    return ((numFailed > 0) || (numRegressed > 0)) ? 1 : 0;
+}